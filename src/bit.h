@@ -5,6 +5,14 @@ class BIT {
  public:
   explicit BIT(int n) : n_(n), t_(n, T(0)) {}
 
+  // same as n calls of Add(i, a[i]) in O(n): every node passes its sum to
+  // its parent i | (i + 1) once
+  explicit BIT(const vector<T> &a) : n_(static_cast<int>(a.size())), t_(a) {
+    for (int i = 0; i < n_; i++) {
+      if (auto p = i | (i + 1); p < n_) t_[p] += t_[i];
+    }
+  }
+
   void Add(int x, T v) {
     assert(x >= 0);
     for (; x < n_; x += (x + 1) & -(x + 1)) t_[x] += v;
@@ -30,7 +38,79 @@ class BIT {
     return Get(r) - (l ? Get(l - 1) : T(0));
   }
 
+  // a such that Get(x) = a[0] + ... + a[x], the inverse of the
+  // constructor in O(n)
+  vector<T> ToArray() const {
+    auto a = t_;
+    for (int i = n_ - 1; i >= 0; i--) {
+      if (auto p = i | (i + 1); p < n_) a[p] -= a[i];
+    }
+    return a;
+  }
+
+  // all values back to 0, keeping the memory
+  void Reset() { fill(t_.begin(), t_.end(), T(0)); }
+
+  // Smallest x such that Get(x) >= k, n if there is none. All values must
+  // be non-negative. Binary lifting over the implicit tree, O(log n)
+  int LowerBound(T k) const {
+    int pos = 0;
+    for (int step = n_ ? 1 << (31 - __builtin_clz(n_)) : 0; step;
+         step >>= 1) {
+      // t_[pos + step - 1] is the sum of [pos, pos + step)
+      if (pos + step <= n_ && t_[pos + step - 1] < k) {
+        pos += step;
+        k -= t_[pos - 1];
+      }
+    }
+    return pos;
+  }
+
  private:
   int n_;
   vector<T> t_;
 };
+
+// Range adding and range sum getting with two interleaved BIT arrays:
+// adding v to [l, n) adds v * (x + 1) - v * l to the prefix sum of x, so
+// t_[i].first keeps the v and t_[i].second the v * l
+template <typename T>
+class RangeBIT {
+ public:
+  explicit RangeBIT(int n) : n_(n), t_(n, {T(0), T(0)}) {}
+
+  // [l, r] INCLUSIVELY
+  void Add(int l, int r, T v) {
+    assert(l <= r && l >= 0 && r < n_);
+    Add(l, v);
+    Add(r + 1, -v);
+  }
+
+  // [l, r] INCLUSIVELY
+  T Get(int l, int r) const {
+    assert(l <= r && r < n_ && l >= 0);
+    return Prefix(r) - (l ? Prefix(l - 1) : T(0));
+  }
+
+ private:
+  void Add(int x, T v) {
+    T w = v * T(x);
+    for (; x < n_; x += (x + 1) & -(x + 1)) {
+      t_[x].first += v;
+      t_[x].second += w;
+    }
+  }
+
+  // sum of [0, x]
+  T Prefix(int x) const {
+    T a(0), b(0);
+    for (int i = x; i >= 0; i -= (i + 1) & -(i + 1)) {
+      a += t_[i].first;
+      b += t_[i].second;
+    }
+    return a * T(x + 1) - b;
+  }
+
+  int n_;
+  vector<pair<T, T>> t_;
+};
@@ -8,33 +8,53 @@ class BitwiseFFT {
    * +1 -1
    */
   template <typename T>
-  static void XorFFT(vector<T> &a, bool invert) {
+  static void XorFFT(vector<T> &a, bool invert, int threads = 1) {
     auto n = static_cast<int>(a.size());
-    for (int i = 1; i < n; i <<= 1) {
-      for (int j = 0; j < n; j += i << 1) {
-        for (int k = 0; k < i; k++) {
-          T u = a[j + k], v = a[i + j + k];
-          a[j + k] = u + v;
-          a[i + j + k] = u - v;
-        }
-      }
-    }
-    if (invert) {
+    Transform(a, threads, [](T &u, T &v) {
+      T w = u;
+      u += v;
+      v = w - v;
+    });
+    if (!invert) return;
+    if constexpr (is_integral<T>::value) {
+      auto lg = __builtin_ctz(n);
+      for (auto &u : a) u >>= lg;
+    } else {
       T inv = T(n).Inv();
       for (auto &u : a) u *= inv;
     }
   }
 
   template <typename T>
-  static vector<T> XorConvolution(vector<T> a, vector<T> b) {
+  static vector<T> XorConvolution(vector<T> a, vector<T> b, int threads = 1) {
+    XorConvolutionInPlace(a, b, threads);
+    return a;
+  }
+
+  // a = XorConvolution(a, b), b is left transformed.
+  // Passing the same vector twice squares it with a single forward transform.
+  // The inverse is the forward transform scaled by 1 / n: the scale is folded
+  // into the pointwise product, or for integer types done with a shift after
+  // the inverse, which is exact since the result is a multiple of n there
+  template <typename T>
+  static void XorConvolutionInPlace(vector<T> &a, vector<T> &b,
+                                    int threads = 1) {
     assert(IsPowerOfTwo(a.size()));
     assert(IsPowerOfTwo(b.size()));
     assert(a.size() == b.size());
-    XorFFT(a, 0);
-    XorFFT(b, 0);
-    for (int i = 0; i < a.size(); i++) a[i] *= b[i];
-    XorFFT(a, 1);
-    return a;
+    auto n = static_cast<int>(a.size());
+    XorFFT(a, 0, threads);
+    if (&a != &b) XorFFT(b, 0, threads);
+    if constexpr (is_integral<T>::value) {
+      for (int i = 0; i < n; i++) a[i] *= b[i];
+      XorFFT(a, 0, threads);
+      auto lg = __builtin_ctz(n);
+      for (auto &u : a) u >>= lg;
+    } else {
+      T inv = T(n).Inv();
+      for (int i = 0; i < n; i++) a[i] *= b[i] * inv;
+      XorFFT(a, 0, threads);
+    }
   }
 
   /*
@@ -43,33 +63,31 @@ class BitwiseFFT {
    * +1 +0
    */
   template <typename T>
-  static void OrFFT(vector<T> &a, bool invert) {
-    auto n = static_cast<int>(a.size());
-    for (int i = 1; i < n; i <<= 1) {
-      for (int j = 0; j < n; j += i << 1) {
-        for (int k = 0; k < i; k++) {
-          T u = a[j + k], v = a[i + j + k];
-          if (!invert) {
-            a[j + k] = u + v;
-            a[i + j + k] = u;
-          } else {
-            a[j + k] = v;
-            a[i + j + k] = u - v;
-          }
-        }
-      }
+  static void OrFFT(vector<T> &a, bool invert, int threads = 1) {
+    if (!invert) {
+      Transform(a, threads, [](T &u, T &v) {
+        T w = u;
+        u += v;
+        v = w;
+      });
+    } else {
+      Transform(a, threads, [](T &u, T &v) {
+        T w = u;
+        u = v;
+        v = w - v;
+      });
     }
   }
 
   template <typename T>
-  static vector<T> OrConvolution(vector<T> a, vector<T> b) {
+  static vector<T> OrConvolution(vector<T> a, vector<T> b, int threads = 1) {
     assert(IsPowerOfTwo(a.size()));
     assert(IsPowerOfTwo(b.size()));
     assert(a.size() == b.size());
-    OrFFT(a, 0);
-    OrFFT(b, 0);
+    OrFFT(a, 0, threads);
+    OrFFT(b, 0, threads);
     for (int i = 0; i < a.size(); i++) a[i] *= b[i];
-    OrFFT(a, 1);
+    OrFFT(a, 1, threads);
     return a;
   }
 
@@ -79,36 +97,418 @@ class BitwiseFFT {
    * +1 +1
    */
   template <typename T>
-  static void AndFFT(vector<T> &a, int invert) {
-    auto n = static_cast<int>(a.size());
-    for (int i = 1; i < n; i <<= 1) {
-      for (int j = 0; j < n; j += i << 1) {
-        for (int k = 0; k < i; k++) {
-          T u = a[j + k], v = a[i + j + k];
-          if (!invert) {
-            a[j + k] = v;
-            a[i + j + k] = u + v;
-          } else {
-            a[j + k] = v - u;
-            a[i + j + k] = u;
-          }
-        }
-      }
+  static void AndFFT(vector<T> &a, int invert, int threads = 1) {
+    if (!invert) {
+      Transform(a, threads, [](T &u, T &v) {
+        T w = u;
+        u = v;
+        v += w;
+      });
+    } else {
+      Transform(a, threads, [](T &u, T &v) {
+        T w = u;
+        u = v - w;
+        v = w;
+      });
     }
   }
 
   template <typename T>
-  static vector<T> AndConvolution(vector<T> a, vector<T> b) {
+  static vector<T> AndConvolution(vector<T> a, vector<T> b, int threads = 1) {
     assert(IsPowerOfTwo(a.size()));
     assert(IsPowerOfTwo(b.size()));
     assert(a.size() == b.size());
-    AndFFT(a, 0);
-    AndFFT(b, 0);
+    AndFFT(a, 0, threads);
+    AndFFT(b, 0, threads);
     for (int i = 0; i < a.size(); i++) a[i] *= b[i];
-    AndFFT(a, 1);
+    AndFFT(a, 1, threads);
     return a;
   }
 
+  /*
+   * Transform over Z_k^n (digit-wise addition mod k), matrix:
+   * w^(i * j), 0 <= i, j < k
+   * for a primitive k-th root of unity w of T. The inverse uses w^-1 and
+   * scales by 1 / a.size()
+   */
+  template <typename T>
+  static void KaryFFT(vector<T> &a, int k, const T &w, bool invert) {
+    assert(k >= 2 && IsPowerOf(a.size(), k));
+    auto size = static_cast<int>(a.size());
+    KaryRootTransform(a, k, invert ? w.Inv() : w);
+    if (!invert) return;
+    T inv = T(size).Inv();
+    for (auto &u : a) u *= inv;
+  }
+
+  // c[x] = sum(a[y] * b[z]) over y + z = x, adding digits mod k in base k.
+  // k must be prime and invertible in T. Uses a k-th root of unity of T
+  // when T::RootOfUnity(k) finds one, else KaryRingTransform
+  template <typename T>
+  static vector<T> KaryXorConvolution(vector<T> a, vector<T> b, int k) {
+    assert(k >= 2);
+    assert(IsPowerOf(a.size(), k));
+    assert(IsPowerOf(b.size(), k));
+    assert(a.size() == b.size());
+    if (k == 2) return XorConvolution(a, b);
+    auto size = static_cast<int>(a.size());
+    T inv = T(size).Inv();
+    if (auto w = RootOfUnity<T>(k, 0); w != T(0)) {
+      KaryRootTransform(a, k, w);
+      KaryRootTransform(b, k, w);
+      for (int i = 0; i < size; i++) a[i] *= b[i] * inv;
+      KaryRootTransform(a, k, w.Inv());
+      return a;
+    }
+    // ring values of d = k - 1 coefficients, a[i] is the constant a[i]
+    auto d = k - 1;
+    vector<T> f(size * d), g(size * d);
+    for (int i = 0; i < size; i++) {
+      f[i * d] = a[i];
+      g[i * d] = b[i];
+    }
+    KaryRingTransform(f, k, false);
+    KaryRingTransform(g, k, false);
+    // product modulo x^k - 1, then modulo 1 + x + ... + x^(k - 1)
+    vector<T> prod(k);
+    for (int i = 0; i < size; i++) {
+      fill(prod.begin(), prod.end(), T(0));
+      for (int p = 0; p < d; p++) {
+        for (int q = 0; q < d; q++) {
+          prod[p + q < k ? p + q : p + q - k] += f[i * d + p] * g[i * d + q];
+        }
+      }
+      for (int p = 0; p < d; p++) f[i * d + p] = (prod[p] - prod[d]) * inv;
+    }
+    KaryRingTransform(f, k, true);
+    for (int i = 0; i < size; i++) a[i] = f[i * d];
+    return a;
+  }
+
+  // Zeta/Moebius transform over multiples, a[d] = sum(a[i]) over d | i.
+  // Indices are 1..n with a.size() = n + 1, a[0] is ignored.
+  // One pass per prime p (a Dirichlet prefix sum), O(n log log n)
+  template <typename T>
+  static void GcdFFT(vector<T> &a, bool invert) {
+    auto n = static_cast<int>(a.size()) - 1;
+    for (auto p : Primes(n)) {
+      if (!invert) {
+        for (int i = n / p; i > 0; i--) a[i] += a[i * p];
+      } else {
+        for (int i = 1; i <= n / p; i++) a[i] -= a[i * p];
+      }
+    }
+  }
+
+  // c[s] = sum(a[x] * b[y]) over gcd(x, y) = s, 1 <= x, y, s <= n
+  template <typename T>
+  static vector<T> GcdConvolution(vector<T> a, vector<T> b) {
+    assert(a.size() == b.size() && !a.empty());
+    GcdFFT(a, 0);
+    GcdFFT(b, 0);
+    for (int i = 1; i < a.size(); i++) a[i] *= b[i];
+    GcdFFT(a, 1);
+    a[0] = T(0);
+    return a;
+  }
+
+  // Zeta/Moebius transform over divisors, a[d] = sum(a[i]) over i | d.
+  // Indices are 1..n with a.size() = n + 1, a[0] is ignored
+  template <typename T>
+  static void LcmFFT(vector<T> &a, bool invert) {
+    auto n = static_cast<int>(a.size()) - 1;
+    for (auto p : Primes(n)) {
+      if (!invert) {
+        for (int i = 1; i <= n / p; i++) a[i * p] += a[i];
+      } else {
+        for (int i = n / p; i > 0; i--) a[i * p] -= a[i];
+      }
+    }
+  }
+
+  // c[s] = sum(a[x] * b[y]) over lcm(x, y) = s, 1 <= x, y, s <= n
+  template <typename T>
+  static vector<T> LcmConvolution(vector<T> a, vector<T> b) {
+    assert(a.size() == b.size() && !a.empty());
+    LcmFFT(a, 0);
+    LcmFFT(b, 0);
+    for (int i = 1; i < a.size(); i++) a[i] *= b[i];
+    LcmFFT(a, 1);
+    a[0] = T(0);
+    return a;
+  }
+
+  // c[s] = sum(a[x] * b[y]) over x | y = s and x & y = 0, O(n^2 2^n)
+  template <typename T>
+  static vector<T> SubsetConvolution(const vector<T> &a, const vector<T> &b) {
+    assert(IsPowerOfTwo(a.size()));
+    assert(IsPowerOfTwo(b.size()));
+    assert(a.size() == b.size());
+    auto size = static_cast<int>(a.size());
+    auto n = __builtin_ctz(size);
+    // rank layers of a mask are contiguous: f[mask * (n + 1) + rank]
+    vector<T> f(size * (n + 1)), g(size * (n + 1));
+    for (int i = 0; i < size; i++) {
+      f[i * (n + 1) + __builtin_popcount(i)] = a[i];
+      g[i * (n + 1) + __builtin_popcount(i)] = b[i];
+    }
+    RankedOrFFT(f, n, 0);
+    RankedOrFFT(g, n, 0);
+    for (int i = 0; i < size; i++) {
+      auto u = i * (n + 1);
+      for (int k = n; k >= 0; k--) {
+        T sum(0);
+        for (int j = 0; j <= k; j++) sum += f[u + j] * g[u + k - j];
+        f[u + k] = sum;
+      }
+    }
+    RankedOrFFT(f, n, 1);
+    vector<T> res(size);
+    for (int i = 0; i < size; i++)
+      res[i] = f[i * (n + 1) + __builtin_popcount(i)];
+    return res;
+  }
+
  private:
+  // Levels below BLOCK are done block by block while the block is in cache
+  static constexpr int BLOCK = 1 << 12;
+
+  // Applies f to (a[k], a[k + i]) for every level i and every k with bit i
+  // unset, on `threads` threads (rounded down to a power of 2).
+  // With t threads and chunk = n / t, the levels >= chunk are split by the
+  // position inside a chunk: a[c], a[c + chunk], ... never meet another c.
+  // The levels < chunk are then done chunk by chunk
+  template <typename T, typename F>
+  static void Transform(vector<T> &a, int threads, const F &f) {
+    assert(threads > 0);
+    auto n = static_cast<int>(a.size());
+    if (n == 0) return;
+    auto t = min(n, 1 << (31 - __builtin_clz(threads)));
+    auto chunk = n / t;
+    ParallelFor(t, [&](int id) {
+      auto lo = id * chunk / t, hi = (id + 1) * chunk / t;
+      for (int i = chunk; i < n; i <<= 1) {
+        for (int j = 0; j < n; j += i << 1) {
+          for (int r = j; r < j + i; r += chunk) {
+            for (int k = r + lo; k < r + hi; k++) {
+              T x = a[k], y = a[i + k];
+              f(x, y);
+              a[k] = x, a[i + k] = y;
+            }
+          }
+        }
+      }
+    });
+    ParallelFor(t, [&](int id) { Transform(a, id * chunk, chunk, f); });
+  }
+
+  // Applies f to the levels < len of a[s, s + len).
+  // Levels below BLOCK are done block by block while the block is in cache,
+  // the remaining levels are done two at a time, halving the passes over a.
+  // f is a template parameter so forward/inverse kernels are inlined without
+  // per-element branches, and since f works on local copies the contiguous
+  // inner loops can be vectorized
+  template <typename T, typename F>
+  static void Transform(vector<T> &a, int s, int len, const F &f) {
+    auto block = min(len, BLOCK);
+    for (int b = s; b < s + len; b += block) {
+      for (int i = 1; i < block; i <<= 1) {
+        for (int j = b; j < b + block; j += i << 1) {
+          for (int k = j; k < j + i; k++) {
+            T x = a[k], y = a[i + k];
+            f(x, y);
+            a[k] = x, a[i + k] = y;
+          }
+        }
+      }
+    }
+    auto i = block;
+    for (; i << 1 < len; i <<= 2) {
+      for (int j = s; j < s + len; j += i << 2) {
+        for (int k = j; k < j + i; k++) {
+          T x = a[k], y = a[i + k], z = a[i * 2 + k], t = a[i * 3 + k];
+          f(x, y);
+          f(z, t);
+          f(x, z);
+          f(y, t);
+          a[k] = x, a[i + k] = y, a[i * 2 + k] = z, a[i * 3 + k] = t;
+        }
+      }
+    }
+    if (i < len) {
+      for (int j = s; j < s + len; j += i << 1) {
+        for (int k = j; k < j + i; k++) {
+          T x = a[k], y = a[i + k];
+          f(x, y);
+          a[k] = x, a[i + k] = y;
+        }
+      }
+    }
+  }
+
+  // primitive k-th root of unity of T if it has RootOfUnity, else 0
+  template <typename T>
+  static auto RootOfUnity(int k, int) -> decltype(T::RootOfUnity(k)) {
+    return T::RootOfUnity(k);
+  }
+  template <typename T>
+  static T RootOfUnity(int, long) {
+    return T(0);
+  }
+
+  // KaryFFT without the scaling. For k = 3, w^2 = -1 - w gives
+  //   y1 = a0 - a2 + w (a1 - a2), y2 = a0 - a1 - w (a1 - a2)
+  // with a single multiplication per group
+  template <typename T>
+  static void KaryRootTransform(vector<T> &a, int k, const T &w) {
+    auto size = static_cast<int>(a.size());
+    if (k == 3) {
+      KaryTransform(size, k, [&](int x, int s) {
+        T a0 = a[x], a1 = a[x + s], a2 = a[x + 2 * s];
+        T t = w * (a1 - a2);
+        a[x] = a0 + a1 + a2;
+        a[x + s] = a0 - a2 + t;
+        a[x + 2 * s] = a0 - a1 - t;
+      });
+      return;
+    }
+    vector<T> pw(k, T(1)), tmp(k);
+    for (int i = 1; i < k; i++) pw[i] = pw[i - 1] * w;
+    KaryTransform(size, k, [&](int x, int s) {
+      for (int j = 0; j < k; j++) {
+        tmp[j] = a[x];
+        for (int i = 1, e = j; i < k; i++, e = e + j < k ? e + j : e + j - k)
+          tmp[j] += pw[e] * a[x + i * s];
+      }
+      for (int j = 0; j < k; j++) a[x + j * s] = tmp[j];
+    });
+  }
+
+  /*
+   * KaryFFT with w = x in the ring T[x] / (1 + x + ... + x^(k - 1)) for
+   * prime k, where x^k = 1, so T needs no k-th root of unity (998244353
+   * has no cube root). Position i holds the k - 1 coefficients
+   * a[i * (k - 1), (i + 1) * (k - 1)), and multiplying by x is a cyclic
+   * shift of k coefficients with the last one, of x^(k - 1), subtracted
+   * from the others. No scaling. For k = 3 the butterfly of
+   * KaryRootTransform needs only additions, with x (c0 + c1 x) =
+   * -c1 + (c0 - c1) x and x^2 (c0 + c1 x) = (c1 - c0) - c0 x
+   */
+  template <typename T>
+  static void KaryRingTransform(vector<T> &a, int k, bool invert) {
+    auto d = k - 1;
+    auto size = static_cast<int>(a.size()) / d;
+    if (k == 3) {
+      KaryTransform(size, k, [&](int x, int s) {
+        auto p0 = x * 2, p1 = (x + s) * 2, p2 = (x + 2 * s) * 2;
+        T a00 = a[p0], a01 = a[p0 + 1], a10 = a[p1], a11 = a[p1 + 1];
+        T a20 = a[p2], a21 = a[p2 + 1];
+        T u0 = a10 - a20, u1 = a11 - a21;
+        T t0 = invert ? u1 - u0 : -u1, t1 = invert ? -u0 : u0 - u1;
+        a[p0] = a00 + a10 + a20, a[p0 + 1] = a01 + a11 + a21;
+        a[p1] = a00 - a20 + t0, a[p1 + 1] = a01 - a21 + t1;
+        a[p2] = a00 - a10 - t0, a[p2 + 1] = a01 - a11 - t1;
+      });
+      return;
+    }
+    // tmp[j * k, (j + 1) * k): output j modulo x^k - 1
+    vector<T> tmp(k * k);
+    KaryTransform(size, k, [&](int x, int s) {
+      for (int j = 0; j < k; j++) {
+        copy_n(a.begin() + x * d, d, tmp.begin() + j * k);
+        tmp[j * k + d] = T(0);
+      }
+      for (int i = 1; i < k; i++) {
+        auto u = (x + i * s) * d;
+        for (int j = 0; j < k; j++) {
+          // multiply by x^(i * j), or x^(-i * j) for the inverse
+          auto e = i * j % k;
+          if (invert && e) e = k - e;
+          auto row = tmp.begin() + j * k;
+          for (int t = 0; t < min(d, k - e); t++) row[e + t] += a[u + t];
+          for (int t = k - e; t < d; t++) row[e + t - k] += a[u + t];
+        }
+      }
+      for (int j = 0; j < k; j++) {
+        auto u = (x + j * s) * d;
+        for (int t = 0; t < d; t++) a[u + t] = tmp[j * k + t] - tmp[j * k + d];
+      }
+    });
+  }
+
+  // Calls f(x, s) for every group (x, x + s, ..., x + (k - 1) s) of every
+  // level s = k^d, with the levels inside a block of size k^b <= BLOCK done
+  // block by block as in Transform
+  template <typename F>
+  static void KaryTransform(int size, int k, const F &f) {
+    auto block = 1;
+    while (block * k <= min(size, BLOCK)) block *= k;
+    for (int b = 0; b < size; b += block) {
+      for (int s = 1; s < block; s *= k) {
+        for (int j = b; j < b + block; j += s * k) {
+          for (int x = j; x < j + s; x++) f(x, s);
+        }
+      }
+    }
+    for (int s = block; s < size; s *= k) {
+      for (int j = 0; j < size; j += s * k) {
+        for (int x = j; x < j + s; x++) f(x, s);
+      }
+    }
+  }
+
+  // Runs f(0), ..., f(t - 1) on t threads, f(0) on the calling thread
+  template <typename F>
+  static void ParallelFor(int t, const F &f) {
+    if (t == 1) return f(0);
+    vector<thread> workers;
+    for (int id = 1; id < t; id++) workers.emplace_back(f, id);
+    f(0);
+    for (auto &worker : workers) worker.join();
+  }
+
+  /*
+   * OR transform applied to every rank of the ranked representation
+   * f[mask * (n + 1) + rank], matrix:
+   * +1 +0
+   * +1 +1
+   */
+  template <typename T>
+  static void RankedOrFFT(vector<T> &f, int n, bool invert) {
+    auto size = 1 << n;
+    for (int i = 1; i < size; i <<= 1) {
+      for (int j = 0; j < size; j += i << 1) {
+        for (int k = 0; k < i; k++) {
+          auto u = (j + k) * (n + 1), v = (i + j + k) * (n + 1);
+          if (!invert) {
+            for (int r = 0; r <= n; r++) f[v + r] += f[u + r];
+          } else {
+            for (int r = 0; r <= n; r++) f[v + r] -= f[u + r];
+          }
+        }
+      }
+    }
+  }
+
+  // primes up to n, linear sieve
+  static vector<int> Primes(int n) {
+    vector<int> primes, lp(n + 1);
+    for (int i = 2; i <= n; i++) {
+      if (!lp[i]) {
+        lp[i] = i;
+        primes.push_back(i);
+      }
+      for (auto p : primes) {
+        if (p > lp[i] || 1ll * i * p > n) break;
+        lp[i * p] = p;
+      }
+    }
+    return primes;
+  }
+
   static bool IsPowerOfTwo(int n) { return n > 0 && n == (n & -n); }
+  static bool IsPowerOf(int n, int k) {
+    while (n > 1 && n % k == 0) n /= k;
+    return n == 1;
+  }
 };
@@ -7,35 +7,111 @@ class FFT {
 
   FFT() : PI(acos(static_cast<D>(-1))) {}
 
+  // Transforms of size >= min_size are split over `threads` threads
+  // (rounded down to a power of 2). Results are identical to the serial path
+  void SetThreads(int threads, int min_size = 1 << 16) {
+    assert(threads > 0);
+    threads_ = threads;
+    min_size_ = min_size;
+  }
+
   void DFT(vector<cp> &a, bool inverse) {
     auto n = static_cast<int>(a.size());
     assert(n == (n & -n) && "size of a is not a power of 2");
     auto base = n == 1 ? 0 : 32 - __builtin_clz(n - 1);
-    for (int i = 1, j = 0; i < n; i++) {
-      for (int k = n >> 1; k > (j ^= k); k >>= 1) {
-      }
-      if (j < i) swap(a[i], a[j]);
-    }
-    if (w_.size() != n) {
+    auto t = n < min_size_ ? 1 : min(n, 1 << (31 - __builtin_clz(threads_)));
+    auto chunk = n / t;
+    ParallelFor(t,
+                [&](int id) { BitReverse(a, id * chunk, (id + 1) * chunk); });
+    // twiddles of the largest size seen so far serve every smaller size
+    if (w_.size() < n) {
       w_.resize(n);
-      for (int i = 0; i < n; i++) w_[i] = polar(static_cast<D>(1), PI * i / n);
-    }
-    for (int i = 0; i < base; i++) {
-      for (int j = 0; j < 1 << i; j++) {
-        for (int k = j; k < n; k += 2 << i) {
-          auto u = a[k];
-          auto v = a[k | 1 << i] * w_[(n >> i) * j];
-          a[k] = u + v;
-          a[k | 1 << i] = u - v;
+      ParallelFor(t, [&](int id) {
+        for (int i = id * chunk; i < (id + 1) * chunk; i++)
+          w_[i] = polar(static_cast<D>(1), PI * i / n);
+      });
+    }
+    // levels whose blocks fit in a chunk are independent between chunks
+    auto low = __builtin_ctz(chunk);
+    ParallelFor(t, [&](int id) {
+      for (int i = 0; i < low; i++) {
+        for (int j = 0; j < 1 << i; j++) {
+          for (int k = id * chunk + j; k < (id + 1) * chunk; k += 2 << i) {
+            Butterfly(a, i, j, k);
+          }
         }
       }
+    });
+    // remaining levels: split the n / 2 butterflies of each level evenly
+    for (int i = low; i < base; i++) {
+      ParallelFor(t, [&](int id) {
+        for (int b = id * chunk >> 1; b < (id + 1) * chunk >> 1; b++) {
+          auto j = b & (1 << i) - 1;
+          Butterfly(a, i, j, (b >> i << i + 1) | j);
+        }
+      });
+    }
+    if (inverse) {
+      // each thread reverses and scales the pairs (i, n - i) of its half chunk
+      ParallelFor(t, [&](int id) {
+        for (int i = id * chunk >> 1; i < (id + 1) * chunk >> 1; i++) {
+          if (i == 0) {
+            a[0] /= n;
+            a[n >> 1] /= n;
+          } else {
+            swap(a[i], a[n - i]);
+            a[i] /= n;
+            a[n - i] /= n;
+          }
+        }
+      });
+    }
+  }
+
+  // DFT of arbitrary length using Bluestein's chirp-z:
+  //   jk = (j^2 + k^2 - (k - j)^2) / 2
+  // which turns the transform into a convolution of power-of-2 size >= 2n - 1
+  void BluesteinDFT(vector<cp> &a, bool inverse) {
+    auto n = static_cast<int>(a.size());
+    if (n == (n & -n)) return DFT(a, inverse);
+    auto base = 32 - __builtin_clz(2 * n - 2);
+    vector<cp> chirp(n);
+    for (int i = 0; i < n; i++) {
+      auto e = static_cast<D>(1ll * i * i % (2 * n));
+      chirp[i] = polar(static_cast<D>(1), PI * e / n);
     }
+    vector<cp> A(1 << base), B(1 << base);
+    for (int i = 0; i < n; i++) A[i] = a[i] * chirp[i];
+    B[0] = conj(chirp[0]);
+    for (int i = 1; i < n; i++) B[i] = B[(1 << base) - i] = conj(chirp[i]);
+    DFT(A, false);
+    DFT(B, false);
+    for (int i = 0; i < 1 << base; i++) A[i] *= B[i];
+    DFT(A, true);
+    for (int i = 0; i < n; i++) a[i] = A[i] * chirp[i];
     if (inverse) {
       reverse(a.begin() + 1, a.end());
       for (auto &u : a) u /= n;
     }
   }
 
+  // res[k] = sum(a[i] * b[j]) over i + j = k (mod n)
+  // One linear Mult of size < 4n and a fold, about 3 times faster than a
+  // size n BluesteinDFT, which costs 3 power of 2 DFTs of size >= 2n
+  template <typename T>
+  vector<T> CyclicConvolve(const vector<T> &a, const vector<T> &b, int n) {
+    assert(n > 0);
+    auto fold = [n](const vector<T> &v) {
+      vector<T> res(min(static_cast<int>(v.size()), n));
+      for (int i = 0; i < v.size(); i++) res[i % n] += v[i];
+      return res;
+    };
+    auto lin = Mult(fold(a), fold(b));
+    vector<T> res(n);
+    for (int i = 0; i < lin.size(); i++) res[i % n] += lin[i];
+    return res;
+  }
+
   template <typename T>
   vector<T> Mult(const vector<T> &a, const vector<T> &b) {
     if (a.empty() || b.empty()) return {};
@@ -45,18 +121,130 @@ class FFT {
     for (int i = 0; i < 1 << cur_base; i++)
       A[i] = cp(i < a.size() ? a[i] : 0, i < b.size() ? b[i] : 0);
     DFT(A, false);
-    vector<cp> B(1 << cur_base);
-    for (int i = 0; i < 1 << cur_base; i++) {
-      int j = i ? (1 << cur_base) - i : 0;
-      B[i] = (A[i] * A[i] - conj(A[j] * A[j])) * cp(0, -0.25);
-    }
+    auto B = PackedProduct(A);
     DFT(B, true);
     vector<T> res(n);
     for (int i = 0; i < n; i++) res[i] = static_cast<T>(round(B[i].real()));
     return res;
   }
 
+  // 2D DFT of a matrix whose dimensions are both powers of 2:
+  // row transforms, blocked transpose, row transforms, transpose back
+  void DFT2D(vector<vector<cp>> &a, bool inverse) {
+    for (auto &row : a) DFT(row, inverse);
+    a = Transpose(a);
+    for (auto &row : a) DFT(row, inverse);
+    a = Transpose(a);
+  }
+
+  // res[i][j] = sum(a[x][y] * b[u][v]) over x + u = i and y + v = j
+  template <typename T>
+  vector<vector<T>> Mult2D(const vector<vector<T>> &a,
+                           const vector<vector<T>> &b) {
+    if (a.empty() || b.empty() || a[0].empty() || b[0].empty()) return {};
+    auto n = static_cast<int>(a.size() + b.size()) - 1;
+    auto m = static_cast<int>(a[0].size() + b[0].size()) - 1;
+    auto row_base = n == 1 ? 0 : 32 - __builtin_clz(n - 1);
+    auto col_base = m == 1 ? 0 : 32 - __builtin_clz(m - 1);
+    vector<vector<cp>> A(1 << row_base, vector<cp>(1 << col_base));
+    for (int i = 0; i < a.size(); i++)
+      for (int j = 0; j < a[i].size(); j++) A[i][j] = cp(a[i][j], 0);
+    for (int i = 0; i < b.size(); i++)
+      for (int j = 0; j < b[i].size(); j++) A[i][j] += cp(0, b[i][j]);
+    DFT2D(A, false);
+    vector<vector<cp>> B(1 << row_base, vector<cp>(1 << col_base));
+    for (int i = 0; i < 1 << row_base; i++) {
+      int ii = i ? (1 << row_base) - i : 0;
+      for (int j = 0; j < 1 << col_base; j++) {
+        int jj = j ? (1 << col_base) - j : 0;
+        B[i][j] = (A[i][j] * A[i][j] - conj(A[ii][jj] * A[ii][jj])) *
+                  cp(0, -0.25);
+      }
+    }
+    DFT2D(B, true);
+    vector<vector<T>> res(n, vector<T>(m));
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < m; j++)
+        res[i][j] = static_cast<T>(round(B[i][j].real()));
+    return res;
+  }
+
+  // res[i] = sum(text[i + j] * pattern[j]) for 0 <= i <= |text| - |pattern|
+  template <typename T>
+  vector<T> CrossCorrelate(const vector<T> &text, const vector<T> &pattern) {
+    auto n = static_cast<int>(text.size());
+    auto m = static_cast<int>(pattern.size());
+    if (m == 0 || m > n) return {};
+    // wrapped around terms only land below index m - 1, so size n is enough
+    auto cur_base = n == 1 ? 0 : 32 - __builtin_clz(n - 1);
+    vector<cp> A(1 << cur_base);
+    for (int i = 0; i < n; i++) A[i] = cp(text[i], 0);
+    for (int i = 0; i < m; i++) A[m - 1 - i] += cp(0, pattern[i]);
+    DFT(A, false);
+    auto B = PackedProduct(A);
+    DFT(B, true);
+    vector<T> res(n - m + 1);
+    for (int i = 0; i + m <= n; i++)
+      res[i] = static_cast<T>(round(B[i + m - 1].real()));
+    return res;
+  }
+
  private:
+  // Runs f(0), ..., f(t - 1) on t threads, f(0) on the calling thread
+  template <typename F>
+  static void ParallelFor(int t, const F &f) {
+    if (t == 1) return f(0);
+    vector<thread> workers;
+    for (int id = 1; id < t; id++) workers.emplace_back(f, id);
+    f(0);
+    for (auto &worker : workers) worker.join();
+  }
+
+  // swaps a[i] and a[rev(i)] for all i in [lo, hi) such that rev(i) < i
+  static void BitReverse(vector<cp> &a, int lo, int hi) {
+    auto n = static_cast<int>(a.size());
+    auto j = 0;
+    for (int k = n >> 1, i = lo; k; k >>= 1, i >>= 1)
+      if (i & 1) j |= k;
+    for (int i = lo; i < hi; i++) {
+      if (j < i) swap(a[i], a[j]);
+      for (int k = n >> 1; k > (j ^= k); k >>= 1) {
+      }
+    }
+  }
+
+  void Butterfly(vector<cp> &a, int i, int j, int k) {
+    auto u = a[k];
+    auto v = a[k | 1 << i] * w_[(static_cast<int>(w_.size()) >> i) * j];
+    a[k] = u + v;
+    a[k | 1 << i] = u - v;
+  }
+
+  static vector<vector<cp>> Transpose(const vector<vector<cp>> &a) {
+    static const int BLOCK = 32;
+    auto n = static_cast<int>(a.size());
+    auto m = static_cast<int>(a[0].size());
+    vector<vector<cp>> res(m, vector<cp>(n));
+    for (int x = 0; x < n; x += BLOCK)
+      for (int y = 0; y < m; y += BLOCK)
+        for (int i = x; i < min(n, x + BLOCK); i++)
+          for (int j = y; j < min(m, y + BLOCK); j++) res[j][i] = a[i][j];
+    return res;
+  }
+
+  // Given the DFT of A = a + i * b, returns the DFT of a * b
+  vector<cp> PackedProduct(const vector<cp> &A) {
+    auto n = static_cast<int>(A.size());
+    vector<cp> B(n);
+    for (int i = 0; i < n; i++) {
+      int j = i ? n - i : 0;
+      B[i] = (A[i] * A[i] - conj(A[j] * A[j])) * cp(0, -0.25);
+    }
+    return B;
+  }
+
   D PI;
   vector<cp> w_;
+  int threads_ = 1;
+  int min_size_ = 1 << 16;
 };
@@ -5,7 +5,12 @@ template <typename D>
 class FFT {
  public:
   using cp = complex<D>;
+  // Inputs are split into 2 parts of M bits, or 3 parts of M3 bits when the
+  // output has more than SPLIT3_MIN_SIZE terms: with 16-bit parts the
+  // convolution terms no longer fit in the precision of double there
   static const int M = 16;
+  static const int M3 = 11;
+  static const int SPLIT3_MIN_SIZE = 1 << 17;
 
   FFT() : PI(acos(static_cast<D>(-1))) {}
 
@@ -18,15 +23,17 @@ class FFT {
       }
       if (j < i) swap(a[i], a[j]);
     }
-    if (w_.size() != n) {
+    // twiddles of the largest size seen so far serve every smaller size
+    if (w_.size() < n) {
       w_.resize(n);
       for (int i = 0; i < n; i++) w_[i] = polar(static_cast<D>(1), PI * i / n);
     }
+    auto m = static_cast<int>(w_.size());
     for (int i = 0; i < base; i++) {
       for (int j = 0; j < 1 << i; j++) {
         for (int k = j; k < n; k += 2 << i) {
           auto u = a[k];
-          auto v = a[k | 1 << i] * w_[(n >> i) * j];
+          auto v = a[k | 1 << i] * w_[(m >> i) * j];
           a[k] = u + v;
           a[k | 1 << i] = u - v;
         }
@@ -38,44 +45,106 @@ class FFT {
     }
   }
 
+  // Every part of a and b is a real signal, packed 2 per complex DFT.
+  // The 2k - 1 products are packed 2 per inverse DFT, the last one goes
+  // through a half size DFT. For k = 2 this is 2 + 1.5 DFTs (1 + 1.5 when
+  // squaring), for k = 3 it is 3 + 2.5 DFTs (2 + 2.5 when squaring)
   template <int T>
   vector<Modular<T>> Mult(const vector<Modular<T>> &a,
-                            const vector<Modular<T>> &b) {
+                          const vector<Modular<T>> &b) {
     if (a.empty() || b.empty()) return {};
     auto n = static_cast<int>(a.size() + b.size()) - 1;
+    auto k = n > SPLIT3_MIN_SIZE ? 3 : 2;
+    auto bits = k == 3 ? M3 : M;
     auto cur_base = n == 1 ? 0 : 32 - __builtin_clz(n - 1);
-    vector<cp> A(1 << cur_base), B(1 << cur_base);
-    for (int i = 0; i < size(a); i++)
-      A[i] = cp(static_cast<int>(a[i]) >> M,
-                static_cast<int>(a[i]) & (1 << M) - 1);
-    for (int i = 0; i < size(b); i++)
-      B[i] = cp(static_cast<int>(b[i]) >> M,
-                static_cast<int>(b[i]) & (1 << M) - 1);
-    DFT(A, false);
-    DFT(B, false);
-    vector<cp> X(1 << cur_base), Y(1 << cur_base);
-    for (int i = 0; i < 1 << cur_base; i++) {
-      int j = i ? (1 << cur_base) - i : 0;
-      auto x = A[i] + conj(A[j]);
-      auto y = B[i] + conj(B[j]);
-      auto z = conj(A[j]) - A[i];
-      auto t = conj(B[j]) - B[i];
-      X[i] = (x * t + y * z) * cp(0, 0.25);
-      Y[i] = x * y * cp(0, 0.25) + z * t * cp(-0.25, 0);
+    auto sz = 1 << cur_base;
+    auto square = &a == &b;
+    // signal s is part s % k of a (s < k) or b (s >= k)
+    auto signals = square ? k : k * 2;
+    vector<vector<cp>> F((signals + 1) / 2, vector<cp>(sz));
+    for (int s = 0; s < signals; s++) {
+      const auto &x = s < k ? a : b;
+      auto shift = bits * (s % k);
+      for (int i = 0; i < x.size(); i++) {
+        D v = static_cast<int>(x[i]) >> shift & (1 << bits) - 1;
+        F[s >> 1][i] += s & 1 ? cp(0, v) : cp(v, 0);
+      }
     }
-    DFT(X, true);
-    DFT(Y, true);
-    vector<Modular<T>> res(n);
-    for (int i = 0; i < n; i++) {
-      int64_t u = static_cast<int64_t>(round(X[i].real())) % T;
-      int64_t v = static_cast<int64_t>(round(Y[i].real())) % T;
-      int64_t w = static_cast<int64_t>(round(Y[i].imag())) % T;
-      res[i] = Modular<T>((u << M) + v + (w << M * 2));
+    for (auto &f : F) DFT(f, false);
+    // product s is sum(a_p * b_q) over p + q = s
+    vector<vector<cp>> G(k, vector<cp>(sz));
+    for (int i = 0; i < sz; i++) {
+      int j = i ? sz - i : 0;
+      cp pa[3], pb[3];
+      for (int p = 0; p < k; p++) {
+        pa[p] = Part(F, p, i, j);
+        pb[p] = square ? pa[p] : Part(F, k + p, i, j);
+      }
+      for (int p = 0; p < k; p++) {
+        for (int q = 0; q < k; q++) {
+          auto s = p + q;
+          G[s >> 1][i] += s & 1 ? MulI(pa[p] * pb[q]) : pa[p] * pb[q];
+        }
+      }
     }
+    vector<Modular<T>> res(n), pw(k * 2 - 1);
+    for (int s = 0; s < k * 2 - 1; s++)
+      pw[s] = Modular<T>(static_cast<int64_t>(1) << bits * s);
+    auto add = [&](int s, int i, D v) {
+      res[i] += Modular<T>(static_cast<int64_t>(round(v)) % T) * pw[s];
+    };
+    for (int s = 0; s + 1 < k; s++) {
+      DFT(G[s], true);
+      for (int i = 0; i < n; i++) {
+        add(s * 2, i, G[s][i].real());
+        add(s * 2 + 1, i, G[s][i].imag());
+      }
+    }
+    auto last = RealInverse(G[k - 1]);
+    for (int i = 0; i < n; i++) add(k * 2 - 2, i, last[i]);
     return res;
   }
 
+  template <int T>
+  vector<Modular<T>> Square(const vector<Modular<T>> &a) {
+    return Mult(a, a);
+  }
+
  private:
+  // spectrum of signal s, given the DFTs F where signal s is the real
+  // (s even) or imaginary (s odd) part of F[s / 2]
+  static cp Part(const vector<vector<cp>> &F, int s, int i, int j) {
+    const auto &f = F[s >> 1];
+    if (s & 1) return -MulI(f[i] - conj(f[j])) / static_cast<D>(2);
+    return (f[i] + conj(f[j])) / static_cast<D>(2);
+  }
+
+  static cp MulI(const cp &x) { return cp(-x.imag(), x.real()); }
+
+  // Inverse DFT of the spectrum of a real signal, using one DFT of half size:
+  //   F[k] = E[k] + w^k O[k], F[k + n / 2] = E[k] - w^k O[k]
+  // where E/O are the spectrums of the even/odd positions.
+  // Requires twiddles of size >= n, i.e. a DFT of size n was done before
+  vector<D> RealInverse(vector<cp> &f) {
+    auto n = static_cast<int>(f.size());
+    if (n == 1) return {f[0].real()};
+    auto h = n >> 1;
+    auto stride = static_cast<int>(w_.size()) / n * 2;
+    vector<cp> z(h);
+    for (int i = 0; i < h; i++) {
+      auto e = (f[i] + f[i + h]) / static_cast<D>(2);
+      auto o = (f[i] - f[i + h]) / static_cast<D>(2) * conj(w_[i * stride]);
+      z[i] = e + MulI(o);
+    }
+    DFT(z, true);
+    vector<D> res(n);
+    for (int i = 0; i < h; i++) {
+      res[i << 1] = z[i].real();
+      res[i << 1 | 1] = z[i].imag();
+    }
+    return res;
+  }
+
   D PI;
   vector<cp> w_;
 };
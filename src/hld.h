@@ -0,0 +1,141 @@
+#include "segment_tree.h"
+
+// whether a node has Reverse(), see HLD::PathQuery
+template <typename T, typename = void>
+struct HasReverse : false_type {};
+
+template <typename T>
+struct HasReverse<T, void_t<decltype(declval<T &>().Reverse())>>
+    : true_type {};
+
+// Heavy-light decomposition of a rooted tree. Vertices get positions in a
+// DFS order that visits the heavy child first, so every heavy chain and
+// every subtree is a contiguous range of positions. A SegmentTree built
+// on Permute(val) then answers path and subtree operations, a path is
+// split into O(log n) ranges. The build is iterative, so path-like trees
+// of any depth are fine.
+// With edges = true a path skips the vertex closest to the root, for
+// values kept on the edge to the parent
+class HLD {
+ public:
+  explicit HLD(const vector<vector<int>> &adj, int root = 0)
+      : n_(static_cast<int>(adj.size())) {
+    parent_.assign(n_, -1);
+    depth_.assign(n_, 0);
+    size_.assign(n_, 1);
+    heavy_.assign(n_, -1);
+    head_.assign(n_, root);
+    pos_.assign(n_, 0);
+    // BFS order, parents come before their children
+    vector<int> order = {root};
+    order.reserve(n_);
+    for (int i = 0; i < order.size(); i++) {
+      auto u = order[i];
+      for (auto v : adj[u]) {
+        if (v == parent_[u]) continue;
+        parent_[v] = u;
+        depth_[v] = depth_[u] + 1;
+        order.push_back(v);
+      }
+    }
+    for (int i = n_ - 1; i > 0; i--) {
+      auto u = order[i], p = parent_[u];
+      size_[p] += size_[u];
+      if (heavy_[p] == -1 || size_[u] > size_[heavy_[p]]) heavy_[p] = u;
+    }
+    // preorder with the heavy child popped right after its parent
+    vector<int> stack = {root};
+    for (int timer = 0; !stack.empty();) {
+      auto u = stack.back();
+      stack.pop_back();
+      pos_[u] = timer++;
+      for (auto v : adj[u]) {
+        if (v == parent_[u] || v == heavy_[u]) continue;
+        head_[v] = v;
+        stack.push_back(v);
+      }
+      if (heavy_[u] != -1) {
+        head_[heavy_[u]] = head_[u];
+        stack.push_back(heavy_[u]);
+      }
+    }
+  }
+
+  // val[v] moved to position Pos(v), to build the SegmentTree from
+  template <typename S>
+  vector<S> Permute(const vector<S> &val) const {
+    vector<S> res(n_);
+    for (int v = 0; v < n_; v++) res[pos_[v]] = val[v];
+    return res;
+  }
+
+  int Pos(int v) const { return pos_[v]; }
+
+  int Lca(int u, int v) const {
+    for (; head_[u] != head_[v]; u = parent_[head_[u]]) {
+      if (depth_[head_[u]] < depth_[head_[v]]) swap(u, v);
+    }
+    return depth_[u] < depth_[v] ? u : v;
+  }
+
+  // calls f(x, y) for the O(log n) position ranges [x, y] of the path u-v
+  template <typename F>
+  void ForPath(int u, int v, bool edges, const F &f) const {
+    for (; head_[u] != head_[v]; u = parent_[head_[u]]) {
+      if (depth_[head_[u]] < depth_[head_[v]]) swap(u, v);
+      f(pos_[head_[u]], pos_[u]);
+    }
+    if (depth_[u] > depth_[v]) swap(u, v);
+    if (pos_[u] + edges <= pos_[v]) f(pos_[u] + edges, pos_[v]);
+  }
+
+  template <typename T, typename S>
+  void PathUpdate(SegmentTree<T> &tree, int u, int v, const S &val,
+                  bool edges = false) const {
+    ForPath(u, v, edges, [&](int x, int y) { tree.Update(x, y, val); });
+  }
+
+  // value of the path from u to v in path order. The parts on the sides of
+  // u and v are each combined in position order, from the LCA down, and the
+  // side of u is then turned around with T::Reverse(), which T must provide
+  // unless it is commutative. Pull gets indices along the part as bounds
+  template <typename T>
+  T PathQuery(SegmentTree<T> &tree, int u, int v, bool edges = false) const {
+    T part[2] = {T::worst(), T::worst()};
+    int len[2] = {0, 0}, w[2] = {u, v};
+    auto prepend = [&](int s, int x, int y) {
+      T cur;
+      cur.Pull(0, len[s] + y - x, tree.Get(x, y), part[s]);
+      part[s] = cur;
+      len[s] += y - x + 1;
+    };
+    while (head_[w[0]] != head_[w[1]]) {
+      int s = depth_[head_[w[0]]] < depth_[head_[w[1]]];
+      prepend(s, pos_[head_[w[s]]], pos_[w[s]]);
+      w[s] = parent_[head_[w[s]]];
+    }
+    // the LCA is w[s ^ 1]
+    int s = depth_[w[0]] < depth_[w[1]];
+    if (pos_[w[s ^ 1]] + edges <= pos_[w[s]]) {
+      prepend(s, pos_[w[s ^ 1]] + edges, pos_[w[s]]);
+    }
+    if constexpr (HasReverse<T>::value) part[0].Reverse();
+    T res;
+    res.Pull(0, len[0] + len[1] - 1, part[0], part[1]);
+    return res;
+  }
+
+  template <typename T, typename S>
+  void SubtreeUpdate(SegmentTree<T> &tree, int v, const S &val) const {
+    tree.Update(pos_[v], pos_[v] + size_[v] - 1, val);
+  }
+
+  template <typename T>
+  T SubtreeQuery(SegmentTree<T> &tree, int v) const {
+    return tree.Get(pos_[v], pos_[v] + size_[v] - 1);
+  }
+
+ private:
+  int n_;
+  vector<int> parent_, depth_, size_, heavy_, head_, pos_;
+};
@@ -0,0 +1,212 @@
+#include "all.h"
+
+// Li Chao tree for minimum of lines a * x + b at the points xs given up
+// front. Nodes use the 2n - 1 preorder layout of SegmentTree, node covering
+// xs[l..r] keeps the line that is lowest at its middle point among those
+// inserted into it. AddLine is O(log n), AddSegment O(log^2 n), Get
+// O(log n). For maximum insert -a, -b and negate the result
+template <typename T>
+class LiChaoTree {
+ public:
+  explicit LiChaoTree(vector<long long> xs) : xs_(std::move(xs)) {
+    sort(xs_.begin(), xs_.end());
+    xs_.erase(unique(xs_.begin(), xs_.end()), xs_.end());
+    n_ = static_cast<int>(xs_.size());
+    assert(n_ > 0);
+    lines_.assign(n_ * 2 - 1, Line());
+  }
+
+  void AddLine(T a, T b) { Add(0, 0, n_ - 1, {a, b}); }
+
+  // line a * x + b that only exists for x in [x1, x2]
+  void AddSegment(T a, T b, long long x1, long long x2) {
+    auto l = lower_bound(xs_.begin(), xs_.end(), x1) - xs_.begin();
+    auto r = upper_bound(xs_.begin(), xs_.end(), x2) - xs_.begin() - 1;
+    if (l > r) return;
+    AddSegment(0, 0, n_ - 1, l, r, {a, b});
+  }
+
+  // minimum at x, which must be one of xs, numeric_limits<T>::max() if no
+  // line covers x
+  T Get(long long x) const {
+    auto i = lower_bound(xs_.begin(), xs_.end(), x) - xs_.begin();
+    assert(i < n_ && xs_[i] == x);
+    auto res = numeric_limits<T>::max();
+    for (int node = 0, l = 0, r = n_ - 1;;) {
+      res = min(res, lines_[node].Eval(x));
+      if (l == r) return res;
+      auto m = l + r >> 1;
+      if (i <= m) {
+        node++, r = m;
+      } else {
+        node = Right(node, l, m), l = m + 1;
+      }
+    }
+  }
+
+ private:
+  // the default line is above everything
+  struct Line {
+    T a = T(0), b = numeric_limits<T>::max();
+    T Eval(long long x) const { return a * T(x) + b; }
+  };
+
+  static int Right(int node, int l, int m) { return node + (m - l + 1 << 1); }
+
+  // keeps the line lower at the middle and sends the other one to the
+  // half where it can still be lower, stops as soon as a line is below the
+  // other one at both ends
+  void Add(int node, int l, int r, Line line) {
+    while (true) {
+      auto &cur = lines_[node];
+      bool left = line.Eval(xs_[l]) < cur.Eval(xs_[l]);
+      bool right = line.Eval(xs_[r]) < cur.Eval(xs_[r]);
+      // one of the lines is below the other on the whole node
+      if (left == right) {
+        if (left) cur = line;
+        return;
+      }
+      auto m = l + r >> 1;
+      bool mid = line.Eval(xs_[m]) < cur.Eval(xs_[m]);
+      if (mid) swap(line, cur);
+      if (left != mid) {
+        node++, r = m;
+      } else {
+        node = Right(node, l, m), l = m + 1;
+      }
+    }
+  }
+
+  void AddSegment(int node, int l, int r, int x, int y, const Line &line) {
+    if (x > r || y < l) return;
+    if (x <= l && r <= y) return Add(node, l, r, line);
+    auto m = l + r >> 1;
+    AddSegment(node + 1, l, m, x, y, line);
+    AddSegment(Right(node, l, m), m + 1, r, x, y, line);
+  }
+
+  int n_;
+  vector<long long> xs_;
+  vector<Line> lines_;
+};
+
+// Li Chao tree over all integers x in [lo, hi] with nodes created on
+// demand from an arena addressed by 32-bit indices, as DynamicSegmentTree.
+// AddLine adds at most one node and AddSegment O(log(hi - lo + 1)), so
+// memory is bounded by the insertions and not by the range, which can be
+// all of long long as long as the lines do not overflow T
+template <typename T>
+class DynamicLiChaoTree {
+ public:
+  DynamicLiChaoTree(long long lo, long long hi, size_t capacity = 0)
+      : lo_(lo), hi_(hi) {
+    assert(lo_ <= hi_);
+    arena_.reserve(max(capacity, size_t(2)));
+    arena_.push_back({Line(), 0, 0});
+    arena_.push_back({Line(), 0, 0});
+  }
+
+  void AddLine(T a, T b) { Add(ROOT, lo_, hi_, {a, b}); }
+
+  // line a * x + b that only exists for x in [x1, x2]
+  void AddSegment(T a, T b, long long x1, long long x2) {
+    x1 = max(x1, lo_), x2 = min(x2, hi_);
+    if (x1 > x2) return;
+    AddSegment(ROOT, lo_, hi_, x1, x2, {a, b});
+  }
+
+  // minimum at x, numeric_limits<T>::max() if no line covers x
+  T Get(long long x) const {
+    assert(lo_ <= x && x <= hi_);
+    auto res = numeric_limits<T>::max();
+    auto l = lo_, r = hi_;
+    for (auto k = ROOT; k;) {
+      res = min(res, arena_[k].line.Eval(x));
+      if (l == r) break;
+      auto m = Mid(l, r);
+      if (x <= m) {
+        k = arena_[k].left, r = m;
+      } else {
+        k = arena_[k].right, l = m + 1;
+      }
+    }
+    return res;
+  }
+
+  size_t Nodes() const { return arena_.size(); }
+
+  // bytes used by the arena
+  size_t Memory() const { return arena_.capacity() * sizeof(Item); }
+
+ private:
+  // node 0 stands for a missing child
+  static constexpr uint32_t ROOT = 1;
+
+  struct Line {
+    T a = T(0), b = numeric_limits<T>::max();
+    T Eval(long long x) const { return a * T(x) + b; }
+  };
+
+  struct Item {
+    Line line;
+    uint32_t left, right;
+  };
+
+  // r - l is taken as unsigned, so [lo, hi] may span all of long long
+  static long long Mid(long long l, long long r) {
+    return l + static_cast<long long>(
+                   (static_cast<unsigned long long>(r) - l) >> 1);
+  }
+
+  uint32_t NewNode(const Line &line) {
+    arena_.push_back({line, 0, 0});
+    return static_cast<uint32_t>(arena_.size()) - 1;
+  }
+
+  // same as LiChaoTree::Add, the line that goes down to a missing child
+  // becomes its first line
+  void Add(uint32_t k, long long l, long long r, Line line) {
+    while (true) {
+      auto &cur = arena_[k].line;
+      bool left = line.Eval(l) < cur.Eval(l);
+      bool right = line.Eval(r) < cur.Eval(r);
+      if (left == right) {
+        if (left) cur = line;
+        return;
+      }
+      auto m = Mid(l, r);
+      bool mid = line.Eval(m) < cur.Eval(m);
+      if (mid) swap(line, cur);
+      auto go_left = left != mid;
+      auto child = go_left ? arena_[k].left : arena_[k].right;
+      if (!child) {
+        auto node = NewNode(line);
+        (go_left ? arena_[k].left : arena_[k].right) = node;
+        return;
+      }
+      k = child;
+      if (go_left) {
+        r = m;
+      } else {
+        l = m + 1;
+      }
+    }
+  }
+
+  void AddSegment(uint32_t k, long long l, long long r, long long x,
+                  long long y, const Line &line) {
+    if (x <= l && r <= y) return Add(k, l, r, line);
+    auto m = Mid(l, r);
+    if (x <= m) {
+      if (!arena_[k].left) arena_[k].left = NewNode(Line());
+      AddSegment(arena_[k].left, l, m, x, y, line);
+    }
+    if (y > m) {
+      if (!arena_[k].right) arena_[k].right = NewNode(Line());
+      AddSegment(arena_[k].right, m + 1, r, x, y, line);
+    }
+  }
+
+  long long lo_, hi_;
+  vector<Item> arena_;
+};
@@ -24,6 +24,28 @@ class Modular {
     return res;
   }
 
+  // primitive k-th root of unity for prime MOD, Modular(0) if k does not
+  // divide MOD - 1. w = g^((MOD - 1) / k) is primitive iff w^(k / q) != 1
+  // for every prime q | k
+  static Modular RootOfUnity(int k) {
+    assert(k > 0);
+    if ((MOD - 1) % k) return Modular(0);
+    vector<int> primes;
+    for (int q = 2, m = k; m > 1; q++) {
+      if (q * q > m) q = m;
+      if (m % q) continue;
+      primes.push_back(q);
+      while (m % q == 0) m /= q;
+    }
+    for (int g = 2;; g++) {
+      auto w = Modular(g).Power((MOD - 1) / k);
+      if (all_of(primes.begin(), primes.end(),
+                 [&](int q) { return w.Power(k / q) != Modular(1); })) {
+        return w;
+      }
+    }
+  }
+
   explicit operator int() const { return v_; }
   explicit operator bool() const { return static_cast<bool>(v_); }
   Modular& operator++() { return *this += Modular(1); }
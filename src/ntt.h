@@ -39,6 +39,36 @@ class NTT {
     }
   }
 
+  // 2D transform of a matrix whose dimensions are both powers of 2:
+  // row transforms, blocked transpose, row transforms, transpose back
+  void FFT2D(vector<vector<Mint>>& a, bool inverse) {
+    for (auto& row : a) FFT(row, inverse);
+    a = Transpose(a);
+    for (auto& row : a) FFT(row, inverse);
+    a = Transpose(a);
+  }
+
+  // res[i][j] = sum(a[x][y] * b[u][v]) over x + u = i and y + v = j
+  vector<vector<Mint>> Mult2D(vector<vector<Mint>> a,
+                              vector<vector<Mint>> b) {
+    if (a.empty() || b.empty() || a[0].empty() || b[0].empty()) return {};
+    auto n = static_cast<int>(a.size() + b.size()) - 1;
+    auto m = static_cast<int>(a[0].size() + b[0].size()) - 1;
+    auto row_base = n == 1 ? 0 : 32 - __builtin_clz(n - 1);
+    auto col_base = m == 1 ? 0 : 32 - __builtin_clz(m - 1);
+    a.resize(1 << row_base), b.resize(1 << row_base);
+    for (auto& row : a) row.resize(1 << col_base);
+    for (auto& row : b) row.resize(1 << col_base);
+    FFT2D(a, false);
+    FFT2D(b, false);
+    for (int i = 0; i < 1 << row_base; i++)
+      for (int j = 0; j < 1 << col_base; j++) a[i][j] *= b[i][j];
+    FFT2D(a, true);
+    a.resize(n);
+    for (auto& row : a) row.resize(m);
+    return a;
+  }
+
   vector<Mint> Mult(vector<Mint> a, vector<Mint> b) {
     if (a.empty() || b.empty()) return {};
     auto n = static_cast<int>(a.size() + b.size()) - 1;
@@ -52,8 +82,63 @@ class NTT {
     return a;
   }
 
+  // Returns all positions i such that text[i + j] matches pattern[j] for all
+  // j, where `wildcard` (in either string) matches any character.
+  // Characters get random codes in [1, MOD) and the wildcard 0, position i
+  // matches iff sum(p * t * (p - t)^2) = 0 modulo MOD. For a mismatch this
+  // sum is a nonzero polynomial of degree 4 in the codes, so it vanishes
+  // with probability at most 4 / (MOD - 1). |text| is at most 2^23
+  vector<int> WildcardMatch(const string& text, const string& pattern,
+                            char wildcard) {
+    auto n = static_cast<int>(text.size());
+    auto m = static_cast<int>(pattern.size());
+    if (m == 0 || m > n) return {};
+    vector<Mint> code(256);
+    for (auto& u : code) u = Mint(rng_() % (MOD - 1) + 1);
+    code[static_cast<uint8_t>(wildcard)] = Mint(0);
+    auto cur_base = n == 1 ? 0 : 32 - __builtin_clz(n - 1);
+    auto sz = 1 << cur_base;
+    // t[k] = text^(k + 1) and p[k] = reversed pattern^(k + 1). Wrapped
+    // around terms only land below index m - 1, so size n is enough
+    vector<vector<Mint>> t(3, vector<Mint>(sz)), p(3, vector<Mint>(sz));
+    for (int i = 0; i < n; i++) {
+      auto c = code[static_cast<uint8_t>(text[i])];
+      t[0][i] = c, t[1][i] = c * c, t[2][i] = c * c * c;
+    }
+    for (int i = 0; i < m; i++) {
+      auto c = code[static_cast<uint8_t>(pattern[i])];
+      p[0][m - 1 - i] = c, p[1][m - 1 - i] = c * c, p[2][m - 1 - i] = c * c * c;
+    }
+    for (auto& f : t) FFT(f, false);
+    for (auto& f : p) FFT(f, false);
+    vector<Mint> r(sz);
+    for (int i = 0; i < sz; i++) {
+      r[i] = p[2][i] * t[0][i] - Mint(2) * p[1][i] * t[1][i] +
+             p[0][i] * t[2][i];
+    }
+    FFT(r, true);
+    vector<int> res;
+    for (int i = 0; i + m <= n; i++)
+      if (!r[i + m - 1]) res.push_back(i);
+    return res;
+  }
+
  private:
+  static vector<vector<Mint>> Transpose(const vector<vector<Mint>>& a) {
+    static const int BLOCK = 32;
+    auto n = static_cast<int>(a.size());
+    auto m = static_cast<int>(a[0].size());
+    vector<vector<Mint>> res(m, vector<Mint>(n));
+    for (int x = 0; x < n; x += BLOCK)
+      for (int y = 0; y < m; y += BLOCK)
+        for (int i = x; i < min(n, x + BLOCK); i++)
+          for (int j = y; j < min(m, y + BLOCK); j++) res[j][i] = a[i][j];
+    return res;
+  }
+
   int max_base_;
   vector<Mint> roots_;  // 0: -1, 1: i, ...
   vector<int> rev_;
+  mt19937 rng_{static_cast<uint32_t>(
+      chrono::steady_clock::now().time_since_epoch().count())};
 };
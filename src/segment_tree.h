@@ -11,19 +11,19 @@ struct Node {
   }
 
   template <typename S>
-  void Apply(int l, int r, const S &val) {
+  void Apply(long long l, long long r, const S &val) {
     sum += val * T(r - l + 1);
     add += val;
   }
 
-  void Pull(int l, int r, const Node &u, const Node &v) {
+  void Pull(long long l, long long r, const Node &u, const Node &v) {
     sum = u.sum + v.sum;
     add = T(0);
   }
 
-  void Push(int l, int r, Node &u, Node &v) {
+  void Push(long long l, long long r, Node &u, Node &v) {
     if (!add) return;
-    int m = l + r >> 1;
+    auto m = l + r >> 1;
     u.Apply(l, m, add);
     v.Apply(m + 1, r, add);
     add = T(0);
@@ -46,19 +46,19 @@ struct NodeMax {
   }
 
   template <typename S>
-  void Apply(int l, int r, const S &val) {
+  void Apply(long long l, long long r, const S &val) {
     max_val += val;
     add += val;
   }
 
-  void Pull(int l, int r, const NodeMax &u, const NodeMax &v) {
+  void Pull(long long l, long long r, const NodeMax &u, const NodeMax &v) {
     max_val = max(u.max_val, v.max_val);
     add = T(0);
   }
 
-  void Push(int l, int r, NodeMax &u, NodeMax &v) {
+  void Push(long long l, long long r, NodeMax &u, NodeMax &v) {
     if (!add) return;
-    int m = l + r >> 1;
+    auto m = l + r >> 1;
     u.Apply(l, m, add);
     v.Apply(m + 1, r, add);
     add = T(0);
@@ -68,42 +68,268 @@ struct NodeMax {
   T add;
 };
 
+// Example for CompactSegmentTree: range adding and range sum getting, with
+// values and lazy tags as separate types
+template <typename T>
+struct SumAdd {
+  using Value = T;
+  using Tag = T;
+
+  static Value Identity() { return T(0); }
+  static Tag NoTag() { return T(0); }
+  static Value Combine(const Value &u, const Value &v) { return u + v; }
+  // value of a node covering [l, r] after applying tag to it
+  static Value Apply(int l, int r, const Value &u, const Tag &tag) {
+    return u + tag * T(r - l + 1);
+  }
+  // tag equal to applying inner then outer
+  static Tag Compose(const Tag &outer, const Tag &inner) {
+    return outer + inner;
+  }
+};
+
+// Node example for segment tree beats: range chmin, range chmax and range
+// adding with range sum, max and min getting. Updates are Op values made by
+// Chmin/Chmax/Add, T(x) is a single position of value x
+template <typename T>
+struct NodeBeats {
+  enum Type { CHMIN, CHMAX, ADD };
+  struct Op {
+    Type type;
+    T x;
+  };
+
+  static Op Chmin(T x) { return {CHMIN, x}; }
+  static Op Chmax(T x) { return {CHMAX, x}; }
+  static Op Add(T x) { return {ADD, x}; }
+
+  explicit NodeBeats(T x = T(0)) {
+    sum = max1 = min1 = x;
+    max2 = LOW, min2 = HIGH;
+    max_cnt = min_cnt = 1;
+    add = T(0);
+  }
+
+  static NodeBeats worst() {
+    NodeBeats res;
+    res.sum = T(0);
+    res.max1 = LOW, res.min1 = HIGH;
+    res.max_cnt = res.min_cnt = 0;
+    return res;
+  }
+
+  // op changes nothing in the node
+  bool Break(long long l, long long r, const Op &op) const {
+    if (op.type == CHMIN) return max1 <= op.x;
+    if (op.type == CHMAX) return min1 >= op.x;
+    return false;
+  }
+
+  // op can be applied to the whole node without visiting its children,
+  // always true on a single position
+  bool Tag(long long l, long long r, const Op &op) const {
+    // max2 < LOW and min2 > HIGH can't hold, so leaves are checked first
+    if (l == r) return true;
+    if (op.type == CHMIN) return max2 < op.x;
+    if (op.type == CHMAX) return min2 > op.x;
+    return true;
+  }
+
+  // requires Tag(l, r, op)
+  void Apply(long long l, long long r, const Op &op) {
+    if (op.type == ADD) {
+      sum += op.x * T(r - l + 1);
+      max1 += op.x, min1 += op.x;
+      if (max2 != LOW) max2 += op.x;
+      if (min2 != HIGH) min2 += op.x;
+      add += op.x;
+    } else if (op.type == CHMIN) {
+      if (max1 <= op.x) return;
+      sum -= (max1 - op.x) * T(max_cnt);
+      if (min1 == max1) {
+        min1 = op.x;
+      } else if (min2 == max1) {
+        min2 = op.x;
+      }
+      max1 = op.x;
+    } else {
+      if (min1 >= op.x) return;
+      sum += (op.x - min1) * T(min_cnt);
+      if (max1 == min1) {
+        max1 = op.x;
+      } else if (max2 == min1) {
+        max2 = op.x;
+      }
+      min1 = op.x;
+    }
+  }
+
+  void Pull(long long l, long long r, const NodeBeats &u,
+            const NodeBeats &v) {
+    sum = u.sum + v.sum;
+    if (u.max1 == v.max1) {
+      max1 = u.max1, max_cnt = u.max_cnt + v.max_cnt;
+      max2 = max(u.max2, v.max2);
+    } else if (u.max1 > v.max1) {
+      max1 = u.max1, max_cnt = u.max_cnt;
+      max2 = max(u.max2, v.max1);
+    } else {
+      max1 = v.max1, max_cnt = v.max_cnt;
+      max2 = max(u.max1, v.max2);
+    }
+    if (u.min1 == v.min1) {
+      min1 = u.min1, min_cnt = u.min_cnt + v.min_cnt;
+      min2 = min(u.min2, v.min2);
+    } else if (u.min1 < v.min1) {
+      min1 = u.min1, min_cnt = u.min_cnt;
+      min2 = min(u.min2, v.min1);
+    } else {
+      min1 = v.min1, min_cnt = v.min_cnt;
+      min2 = min(u.min1, v.min2);
+    }
+    add = T(0);
+  }
+
+  // the children get the pending add, then are clamped into [min1, max1]
+  void Push(long long l, long long r, NodeBeats &u, NodeBeats &v) {
+    auto m = l + r >> 1;
+    if (add != T(0)) {
+      u.Apply(l, m, Add(add));
+      v.Apply(m + 1, r, Add(add));
+      add = T(0);
+    }
+    u.Apply(l, m, Chmin(max1));
+    v.Apply(m + 1, r, Chmin(max1));
+    u.Apply(l, m, Chmax(min1));
+    v.Apply(m + 1, r, Chmax(min1));
+  }
+
+  static constexpr T LOW = numeric_limits<T>::min();
+  static constexpr T HIGH = numeric_limits<T>::max();
+
+  T sum;
+  // largest value, strictly second largest value and count of the largest
+  T max1, max2;
+  int max_cnt;
+  T min1, min2;
+  int min_cnt;
+  T add;
+};
+
 template <typename T>
 class SegmentTree {
  public:
-  explicit SegmentTree(int n) : n_(n) { t_.assign(n_ << 2 | 1, T()); }
+  // Nodes are stored in preorder: the left child of node is node + 1 and the
+  // right child comes after the 2 * size - 1 nodes of the left subtree, so
+  // the tree takes exactly 2n - 1 nodes, and a single one when n = 0
+  explicit SegmentTree(int n) : n_(n) { t_.assign(max(1, n_ * 2 - 1), T()); }
 
   template <typename S>
   SegmentTree(int n, const vector<S> &val) : n_(n) {
-    t_.assign(n_ << 2 | 1, T());
-    Init(1, 0, n_ - 1, val);
+    t_.assign(max(1, n_ * 2 - 1), T());
+    if (n_ > 0) Init(0, 0, n_ - 1, val);
+  }
+
+  // Same tree built on `threads` threads: every subtree is a contiguous
+  // block of t_ in preorder, so threads build disjoint subtrees and only
+  // the few nodes above them are pulled after the joins
+  template <typename S>
+  SegmentTree(int n, const vector<S> &val, int threads) : n_(n) {
+    assert(threads > 0);
+    t_.assign(max(1, n_ * 2 - 1), T());
+    if (n_ > 0) Init(0, 0, n_ - 1, val, threads);
   }
 
   // apply `val` to all position in range [x, y]
   template <typename S>
   void Update(int x, int y, const S &val) {
-    Update(1, 0, n_ - 1, x, y, val);
+    Update(0, 0, n_ - 1, x, y, val);
+  }
+
+  T Get(int x, int y) { return Get(0, 0, n_ - 1, x, y); }
+
+  // Get that leaves the tree untouched: tags are pushed into local copies,
+  // so several threads can call it at once while no one updates the tree
+  T Get(int x, int y) const {
+    assert(0 <= x && x <= y && y < n_);
+    return Get(t_[0], 0, 0, n_ - 1, x, y);
+  }
+
+  // Same as calling Update(x, y, val) for each (x, y, val) in order, in one
+  // traversal where consecutive updates reaching a node share its push and
+  // pull. Worth it when Push/Pull are expensive, as for range affine maps
+  // modulo a prime; on cheap nodes it costs about as much as single calls
+  template <typename S>
+  void ApplyBatch(const vector<tuple<int, int, S>> &updates) {
+    vector<array<int, 3>> buf;
+    buf.reserve(updates.size() * 2);
+    for (int i = 0; i < updates.size(); i++) {
+      buf.push_back({get<0>(updates[i]), get<1>(updates[i]), i});
+    }
+    ApplyBatch(0, 0, n_ - 1, updates, buf, 0, static_cast<int>(buf.size()));
   }
 
-  T Get(int x, int y) { return Get(1, 0, n_ - 1, x, y); }
+  // Get(x, y) of each (x, y) in one sweep over the ranges sorted by x,
+  // pushing each node at most once. Same trade-off as ApplyBatch
+  vector<T> QueryBatch(const vector<pair<int, int>> &ranges) {
+    vector<T> res(ranges.size(), T::worst());
+    vector<array<int, 3>> buf;
+    buf.reserve(ranges.size());
+    for (int i = 0; i < ranges.size(); i++) {
+      auto [x, y] = ranges[i];
+      if (x <= 0 && n_ - 1 <= y) {
+        Take(res[i], x, n_ - 1, t_[0]);
+      } else {
+        buf.push_back({x, y, i});
+      }
+    }
+    sort(buf.begin(), buf.end());
+    if (!buf.empty()) {
+      QueryBatch(0, 0, n_ - 1, buf, 0, static_cast<int>(buf.size()), res);
+    }
+    return res;
+  }
 
   // LeftMostHas/RightMostHas returns the left/right most position v
   // such that:
   //   - v is in the segment [x, y]
   //   - and f(u) = true if node u contains position v
   // Returns -1 if we can't find such position v
-  template <typename S>
-  int LeftMostHas(int x, int y, const function<bool(const T &, const S &)> &f,
-                  const S &val) {
-    return LeftMostHas(1, 0, n_ - 1, x, y, f, val);
+  // f can be any callable f(const T &, const S &) -> bool
+  template <typename S, typename F>
+  int LeftMostHas(int x, int y, const F &f, const S &val) {
+    return LeftMostHas(0, 0, n_ - 1, x, y, f, val);
   }
-  template <typename S>
-  int RightMostHas(int x, int y, const function<bool(const T &, const S &)> &f,
-                   const S &val) {
-    return RightMostHas(1, 0, n_ - 1, x, y, f, val);
+  template <typename S, typename F>
+  int RightMostHas(int x, int y, const F &f, const S &val) {
+    return RightMostHas(0, 0, n_ - 1, x, y, f, val);
+  }
+
+  // MaxRight returns the largest y such that f(Get(x, y)) = true,
+  // or x - 1 if there is none.
+  // MinLeft returns the smallest x such that f(Get(x, y)) = true,
+  // or y + 1 if there is none.
+  // f must be monotone (true on a range implies true on its subranges) and
+  // f(T::worst()) = true. Both run in O(log n)
+  template <typename F>
+  int MaxRight(int x, const F &f) {
+    assert(0 <= x && x < n_);
+    T acc = T::worst();
+    auto res = MaxRight(0, 0, n_ - 1, x, f, acc);
+    return res == -1 ? n_ - 1 : res - 1;
+  }
+  template <typename F>
+  int MinLeft(int y, const F &f) {
+    assert(0 <= y && y < n_);
+    T acc = T::worst();
+    auto res = MinLeft(0, 0, n_ - 1, y, f, acc);
+    return res == -1 ? 0 : res + 1;
   }
 
  private:
+  // right child of node whose left child covers [l, m]
+  static int Right(int node, int l, int m) { return node + (m - l + 1 << 1); }
+
   template <typename S>
   void Init(int node, int l, int r, const vector<S> &val) {
     if (l == r) {
@@ -111,9 +337,22 @@ class SegmentTree {
       return;
     }
     auto m = l + r >> 1;
-    Init(node << 1, l, m, val);
-    Init(node << 1 | 1, m + 1, r, val);
-    t_[node].Pull(l, r, t_[node << 1], t_[node << 1 | 1]);
+    Init(node + 1, l, m, val);
+    Init(Right(node, l, m), m + 1, r, val);
+    t_[node].Pull(l, r, t_[node + 1], t_[Right(node, l, m)]);
+  }
+
+  // the right half goes to a new thread with half of the threads
+  template <typename S>
+  void Init(int node, int l, int r, const vector<S> &val, int threads) {
+    if (threads == 1 || l == r) return Init(node, l, r, val);
+    auto m = l + r >> 1;
+    thread worker([&] {
+      Init(Right(node, l, m), m + 1, r, val, threads - threads / 2);
+    });
+    Init(node + 1, l, m, val, threads / 2);
+    worker.join();
+    t_[node].Pull(l, r, t_[node + 1], t_[Right(node, l, m)]);
   }
 
   template <typename S>
@@ -124,54 +363,790 @@ class SegmentTree {
       return;
     }
     auto m = l + r >> 1;
-    t_[node].Push(l, r, t_[node << 1], t_[node << 1 | 1]);
-    Update(node << 1, l, m, x, y, val);
-    Update(node << 1 | 1, m + 1, r, x, y, val);
-    t_[node].Pull(l, r, t_[node << 1], t_[node << 1 | 1]);
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    Update(node + 1, l, m, x, y, val);
+    Update(Right(node, l, m), m + 1, r, x, y, val);
+    t_[node].Pull(l, r, t_[node + 1], t_[Right(node, l, m)]);
   }
 
   T Get(int node, int l, int r, int x, int y) {
     if (x > r || y < l) return T::worst();
     if (x <= l && r <= y) return t_[node];
     auto m = l + r >> 1;
-    t_[node].Push(l, r, t_[node << 1], t_[node << 1 | 1]);
-    T p1 = Get(node << 1, l, m, x, y);
-    T p2 = Get(node << 1 | 1, m + 1, r, x, y);
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    T p1 = Get(node + 1, l, m, x, y);
+    T p2 = Get(Right(node, l, m), m + 1, r, x, y);
+    T res;
+    res.Pull(l, r, p1, p2);
+    return res;
+  }
+
+  // cur is t_[node] with the tags of its ancestors applied
+  T Get(const T &cur, int node, int l, int r, int x, int y) const {
+    if (x <= l && r <= y) return cur;
+    auto m = l + r >> 1;
+    T tmp = cur, u = t_[node + 1], v = t_[Right(node, l, m)];
+    tmp.Push(l, r, u, v);
+    if (y <= m) return Get(u, node + 1, l, m, x, y);
+    if (x > m) return Get(v, Right(node, l, m), m + 1, r, x, y);
+    T p1 = Get(u, node + 1, l, m, x, y);
+    T p2 = Get(v, Right(node, l, m), m + 1, r, x, y);
     T res;
     res.Pull(l, r, p1, p2);
     return res;
   }
 
+  // buf[b..e) are the updates (x, y, index) intersecting [l, r] in order.
+  // Updates covering the node are applied to it, each run of the others is
+  // sent down with one push/pull, a run of one update takes the path of
+  // Update. The lists of the children are appended to buf and removed
+  // afterwards
   template <typename S>
-  int LeftMostHas(int node, int l, int r, int x, int y,
-                  const function<bool(const T &, const S &)> &f, const S &val) {
+  void ApplyBatch(int node, int l, int r,
+                  const vector<tuple<int, int, S>> &updates,
+                  vector<array<int, 3>> &buf, int b, int e) {
+    auto size = static_cast<int>(buf.size());
+    while (b < e) {
+      if (buf[b][0] <= l && r <= buf[b][1]) {
+        t_[node].Apply(l, r, get<2>(updates[buf[b++][2]]));
+        continue;
+      }
+      if (b + 1 == e || (buf[b + 1][0] <= l && r <= buf[b + 1][1])) {
+        auto [x, y, id] = buf[b++];
+        Update(node, l, r, x, y, get<2>(updates[id]));
+        continue;
+      }
+      auto m = l + r >> 1;
+      auto last = b;
+      for (; last < e && !(buf[last][0] <= l && r <= buf[last][1]); last++) {
+        if (buf[last][0] <= m) buf.push_back(buf[last]);
+      }
+      auto mid = static_cast<int>(buf.size());
+      for (int i = b; i < last; i++) {
+        if (buf[i][1] > m) buf.push_back(buf[i]);
+      }
+      auto end = static_cast<int>(buf.size());
+      t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+      ApplyBatch(node + 1, l, m, updates, buf, size, mid);
+      ApplyBatch(Right(node, l, m), m + 1, r, updates, buf, mid, end);
+      t_[node].Pull(l, r, t_[node + 1], t_[Right(node, l, m)]);
+      buf.resize(size);
+      b = last;
+    }
+  }
+
+  // buf[b..e) are the ranges (x, y, index) intersecting [l, r] without
+  // covering it. Ranges covering a child take it right away, so a child
+  // never gets a range covering it. The others are partitioned in place
+  // into [A][B][C][D]: A goes to the left child only, B to both, C to the
+  // right child only and D is done. The left child reorders [A][B], which
+  // is partitioned again before [B][C] goes right, so nothing is copied.
+  // A lone range takes the path of Get
+  void QueryBatch(int node, int l, int r, vector<array<int, 3>> &buf, int b,
+                  int e, vector<T> &res) {
+    if (e - b == 1) {
+      auto [x, y, id] = buf[b];
+      return Take(res[id], x, min(y, r), Get(node, l, r, x, y));
+    }
+    auto m = l + r >> 1;
+    auto left = node + 1, right = Right(node, l, m);
+    t_[node].Push(l, r, t_[left], t_[right]);
+    // one pass partitions buf[b..e) into [A and B mixed][C][D]
+    auto lo = b, hi = e;
+    for (int i = b; i < hi;) {
+      auto [x, y, id] = buf[i];
+      if (x <= l && y >= m) Take(res[id], x, m, t_[left]);
+      if (x > m || (x <= l && y > m)) {
+        // C, or D if it covers the right child
+        if (x == m + 1 && y >= r) {
+          Take(res[id], x, r, t_[right]);
+          swap(buf[i], buf[--hi]);
+        } else {
+          i++;
+        }
+      } else if (x <= l && y == m) {
+        swap(buf[i], buf[--hi]);
+      } else {
+        swap(buf[i++], buf[lo++]);
+      }
+    }
+    if (lo > b) QueryBatch(left, l, m, buf, b, lo, res);
+    // A ranges reaching past the right child take it after the left one,
+    // B ranges are moved next to C
+    auto split = lo;
+    for (int i = lo - 1; i >= b; i--) {
+      auto [x, y, id] = buf[i];
+      if (y >= r) {
+        Take(res[id], m + 1, r, t_[right]);
+      } else if (y > m) {
+        swap(buf[i], buf[--split]);
+      }
+    }
+    if (split < hi) QueryBatch(right, m + 1, r, buf, split, hi, res);
+  }
+
+  // res = res followed by val, which ends at position r
+  static void Take(T &res, int x, int r, const T &val) {
+    T cur;
+    cur.Pull(x, r, res, val);
+    res = cur;
+  }
+
+  template <typename S, typename F>
+  int LeftMostHas(int node, int l, int r, int x, int y, const F &f,
+                  const S &val) {
     if (x > r || y < l) return -1;
     if (!f(t_[node], val)) return -1;
     if (l == r) return l;
     int m = l + r >> 1;
-    t_[node].Push(l, r, t_[node << 1], t_[node << 1 | 1]);
-    if (int res = LeftMostHas(node << 1, l, m, x, y, f, val); res != -1) {
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    if (int res = LeftMostHas(node + 1, l, m, x, y, f, val); res != -1) {
       return res;
     }
-    return LeftMostHas(node << 1 | 1, m + 1, r, x, y, f, val);
+    return LeftMostHas(Right(node, l, m), m + 1, r, x, y, f, val);
   }
 
-  template <typename S>
-  int RightMostHas(int node, int l, int r, int x, int y,
-                   const function<bool(const T &, const S &)> &f,
+  template <typename S, typename F>
+  int RightMostHas(int node, int l, int r, int x, int y, const F &f,
                    const S &val) {
     if (x > r || y < l) return -1;
     if (!f(t_[node], val)) return -1;
     if (l == r) return l;
     int m = l + r >> 1;
-    t_[node].Push(l, r, t_[node << 1], t_[node << 1 | 1]);
-    if (int res = RightMostHas(node << 1 | 1, m + 1, r, x, y, f, val);
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    if (int res = RightMostHas(Right(node, l, m), m + 1, r, x, y, f, val);
         res != -1) {
       return res;
     }
-    return RightMostHas(node << 1, l, m, x, y, f, val);
+    return RightMostHas(node + 1, l, m, x, y, f, val);
+  }
+
+  // first position p >= x in [l, r] such that f fails on [x, p],
+  // or -1 after adding all of [max(l, x), r] to acc
+  template <typename F>
+  int MaxRight(int node, int l, int r, int x, const F &f, T &acc) {
+    if (r < x) return -1;
+    if (x <= l) {
+      T res;
+      res.Pull(x, r, acc, t_[node]);
+      if (f(res)) {
+        acc = res;
+        return -1;
+      }
+      if (l == r) return l;
+    }
+    int m = l + r >> 1;
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    if (int res = MaxRight(node + 1, l, m, x, f, acc); res != -1) return res;
+    return MaxRight(Right(node, l, m), m + 1, r, x, f, acc);
+  }
+
+  // last position p <= y in [l, r] such that f fails on [p, y],
+  // or -1 after adding all of [l, min(r, y)] to acc
+  template <typename F>
+  int MinLeft(int node, int l, int r, int y, const F &f, T &acc) {
+    if (l > y) return -1;
+    if (r <= y) {
+      T res;
+      res.Pull(l, y, t_[node], acc);
+      if (f(res)) {
+        acc = res;
+        return -1;
+      }
+      if (l == r) return l;
+    }
+    int m = l + r >> 1;
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    if (int res = MinLeft(Right(node, l, m), m + 1, r, y, f, acc); res != -1) {
+      return res;
+    }
+    return MinLeft(node + 1, l, m, y, f, acc);
   }
 
   int n_;
   vector<T> t_;
 };
+
+// Segment tree beats (Ji's segment tree) with the 2n - 1 layout of
+// SegmentTree. Besides Apply/Pull/Push, a node provides Break(l, r, val),
+// true if val changes nothing below it, and Tag(l, r, val), true if val can
+// be applied to it directly, which must hold on leaves. T(x) builds a leaf
+// of value x. With NodeBeats all operations are amortized O(log^2 n)
+template <typename T>
+class SegmentTreeBeats {
+ public:
+  explicit SegmentTreeBeats(int n) : n_(n) {
+    t_.assign(max(1, n_ * 2 - 1), T());
+    if (n_ > 0) Init(0, 0, n_ - 1, [](int) { return T(); });
+  }
+
+  template <typename S>
+  SegmentTreeBeats(int n, const vector<S> &val) : n_(n) {
+    t_.assign(max(1, n_ * 2 - 1), T());
+    if (n_ > 0) Init(0, 0, n_ - 1, [&](int i) { return T(val[i]); });
+  }
+
+  // apply `val` to all position in range [x, y]
+  template <typename S>
+  void Update(int x, int y, const S &val) {
+    Update(0, 0, n_ - 1, x, y, val);
+  }
+
+  T Get(int x, int y) { return Get(0, 0, n_ - 1, x, y); }
+
+ private:
+  static int Right(int node, int l, int m) { return node + (m - l + 1 << 1); }
+
+  template <typename F>
+  void Init(int node, int l, int r, const F &leaf) {
+    if (l == r) {
+      t_[node] = leaf(l);
+      return;
+    }
+    auto m = l + r >> 1;
+    Init(node + 1, l, m, leaf);
+    Init(Right(node, l, m), m + 1, r, leaf);
+    t_[node].Pull(l, r, t_[node + 1], t_[Right(node, l, m)]);
+  }
+
+  template <typename S>
+  void Update(int node, int l, int r, int x, int y, const S &val) {
+    if (x > r || y < l || t_[node].Break(l, r, val)) return;
+    if (x <= l && r <= y && t_[node].Tag(l, r, val)) {
+      t_[node].Apply(l, r, val);
+      return;
+    }
+    auto m = l + r >> 1;
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    Update(node + 1, l, m, x, y, val);
+    Update(Right(node, l, m), m + 1, r, x, y, val);
+    t_[node].Pull(l, r, t_[node + 1], t_[Right(node, l, m)]);
+  }
+
+  T Get(int node, int l, int r, int x, int y) {
+    if (x > r || y < l) return T::worst();
+    if (x <= l && r <= y) return t_[node];
+    auto m = l + r >> 1;
+    t_[node].Push(l, r, t_[node + 1], t_[Right(node, l, m)]);
+    T p1 = Get(node + 1, l, m, x, y);
+    T p2 = Get(Right(node, l, m), m + 1, r, x, y);
+    T res;
+    res.Pull(l, r, p1, p2);
+    return res;
+  }
+
+  int n_;
+  vector<T> t_;
+};
+
+// Non-recursive lazy segment tree on a power-of-2 layout with the same
+// Node concept as SegmentTree. Node k covers a power-of-2 range, leaves
+// n..size_ - 1 are padding filled with T::worst() and never updated.
+// Update/Get only push/pull along the paths of the two boundaries
+template <typename T>
+class BottomUpSegmentTree {
+ public:
+  explicit BottomUpSegmentTree(int n) : n_(n) {
+    log_ = n_ <= 1 ? 0 : 32 - __builtin_clz(n_ - 1);
+    size_ = 1 << log_;
+    t_.assign(size_ << 1, T());
+    for (int i = n_; i < size_; i++) t_[size_ + i] = T::worst();
+    for (int k = size_ - 1; k > 0; k--) Pull(k);
+  }
+
+  template <typename S>
+  BottomUpSegmentTree(int n, const vector<S> &val) : n_(n) {
+    log_ = n_ <= 1 ? 0 : 32 - __builtin_clz(n_ - 1);
+    size_ = 1 << log_;
+    t_.assign(size_ << 1, T());
+    for (int i = 0; i < n_; i++) t_[size_ + i].Apply(i, i, val[i]);
+    for (int i = n_; i < size_; i++) t_[size_ + i] = T::worst();
+    for (int k = size_ - 1; k > 0; k--) Pull(k);
+  }
+
+  // apply `val` to all position in range [x, y]
+  template <typename S>
+  void Update(int x, int y, const S &val) {
+    assert(0 <= x && x <= y && y < n_);
+    x += size_, y += size_ + 1;
+    PushBoundaries(x, y);
+    for (int l = x, r = y; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) Apply(l++, val);
+      if (r & 1) Apply(--r, val);
+    }
+    for (int i = 1; i <= log_; i++) {
+      if (((x >> i) << i) != x) Pull(x >> i);
+      if (((y >> i) << i) != y) Pull((y - 1) >> i);
+    }
+  }
+
+  T Get(int x, int y) {
+    assert(0 <= x && x <= y && y < n_);
+    auto lo = x, hi = y;
+    x += size_, y += size_ + 1;
+    PushBoundaries(x, y);
+    // left covers [lo, ...], right covers [..., hi]
+    T left = T::worst(), right = T::worst();
+    for (; x < y; x >>= 1, y >>= 1) {
+      if (x & 1) {
+        T res;
+        res.Pull(lo, Range(x).second, left, t_[x]);
+        left = res;
+        x++;
+      }
+      if (y & 1) {
+        y--;
+        T res;
+        res.Pull(Range(y).first, hi, t_[y], right);
+        right = res;
+      }
+    }
+    T res;
+    res.Pull(lo, hi, left, right);
+    return res;
+  }
+
+  // Same contracts as SegmentTree::MaxRight/MinLeft, walking up from the
+  // boundary leaf and then down to the first failing leaf
+  template <typename F>
+  int MaxRight(int x, const F &f) {
+    assert(0 <= x && x < n_);
+    auto lo = x;
+    x += size_;
+    for (int i = log_; i > 0; i--) Push(x >> i);
+    T acc = T::worst();
+    do {
+      while (!(x & 1)) x >>= 1;
+      T res;
+      res.Pull(lo, Range(x).second, acc, t_[x]);
+      if (!f(res)) {
+        while (x < size_) {
+          Push(x);
+          x <<= 1;
+          T cur;
+          cur.Pull(lo, Range(x).second, acc, t_[x]);
+          if (f(cur)) {
+            acc = cur;
+            x++;
+          }
+        }
+        return x - size_ - 1;
+      }
+      acc = res;
+      x++;
+    } while ((x & -x) != x);
+    return n_ - 1;
+  }
+
+  template <typename F>
+  int MinLeft(int y, const F &f) {
+    assert(0 <= y && y < n_);
+    auto hi = y;
+    y += size_ + 1;
+    for (int i = log_; i > 0; i--) Push((y - 1) >> i);
+    T acc = T::worst();
+    do {
+      y--;
+      while (y > 1 && (y & 1)) y >>= 1;
+      T res;
+      res.Pull(Range(y).first, hi, t_[y], acc);
+      if (!f(res)) {
+        while (y < size_) {
+          Push(y);
+          y = y << 1 | 1;
+          T cur;
+          cur.Pull(Range(y).first, hi, t_[y], acc);
+          if (f(cur)) {
+            acc = cur;
+            y--;
+          }
+        }
+        return y + 1 - size_;
+      }
+      acc = res;
+    } while ((y & -y) != y);
+    return 0;
+  }
+
+ private:
+  // [l, r] covered by node k
+  pair<int, int> Range(int k) const {
+    auto h = 31 - __builtin_clz(k);
+    auto width = size_ >> h;
+    auto l = (k ^ 1 << h) * width;
+    return {l, l + width - 1};
+  }
+
+  template <typename S>
+  void Apply(int k, const S &val) {
+    auto [l, r] = Range(k);
+    t_[k].Apply(l, r, val);
+  }
+
+  void Pull(int k) {
+    auto [l, r] = Range(k);
+    t_[k].Pull(l, r, t_[k << 1], t_[k << 1 | 1]);
+  }
+
+  void Push(int k) {
+    auto [l, r] = Range(k);
+    t_[k].Push(l, r, t_[k << 1], t_[k << 1 | 1]);
+  }
+
+  // push the tags of every ancestor of the leaves x and y - 1 whose range
+  // is not entirely inside [x, y)
+  void PushBoundaries(int x, int y) {
+    for (int i = log_; i > 0; i--) {
+      if (((x >> i) << i) != x) Push(x >> i);
+      if (((y >> i) << i) != y) Push((y - 1) >> i);
+    }
+  }
+
+  int n_, log_, size_;
+  vector<T> t_;
+};
+
+// Structure-of-arrays variant of BottomUpSegmentTree: values of all
+// 2 * size nodes and lazy tags of the size internal nodes are kept in
+// separate arrays, so leaves carry no tag. M provides Value, Tag and the
+// operations of SumAdd
+template <typename M>
+class CompactSegmentTree {
+ public:
+  using Value = typename M::Value;
+  using Tag = typename M::Tag;
+
+  explicit CompactSegmentTree(int n)
+      : CompactSegmentTree(n, vector<Value>(n, M::Identity())) {}
+
+  CompactSegmentTree(int n, const vector<Value> &val) : n_(n) {
+    log_ = n_ <= 1 ? 0 : 32 - __builtin_clz(n_ - 1);
+    size_ = 1 << log_;
+    val_.assign(size_ << 1, M::Identity());
+    tag_.assign(size_, M::NoTag());
+    copy(val.begin(), val.begin() + n_, val_.begin() + size_);
+    for (int k = size_ - 1; k > 0; k--) Pull(k);
+  }
+
+  // apply `tag` to all position in range [x, y]
+  void Update(int x, int y, const Tag &tag) {
+    assert(0 <= x && x <= y && y < n_);
+    x += size_, y += size_ + 1;
+    PushBoundaries(x, y);
+    for (int l = x, r = y; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) Apply(l++, tag);
+      if (r & 1) Apply(--r, tag);
+    }
+    for (int i = 1; i <= log_; i++) {
+      if (((x >> i) << i) != x) Pull(x >> i);
+      if (((y >> i) << i) != y) Pull((y - 1) >> i);
+    }
+  }
+
+  Value Get(int x, int y) {
+    assert(0 <= x && x <= y && y < n_);
+    x += size_, y += size_ + 1;
+    PushBoundaries(x, y);
+    Value left = M::Identity(), right = M::Identity();
+    for (; x < y; x >>= 1, y >>= 1) {
+      if (x & 1) left = M::Combine(left, val_[x++]);
+      if (y & 1) right = M::Combine(val_[--y], right);
+    }
+    return M::Combine(left, right);
+  }
+
+  // bytes used by the nodes
+  size_t Memory() const {
+    return val_.size() * sizeof(Value) + tag_.size() * sizeof(Tag);
+  }
+
+ private:
+  void Apply(int k, const Tag &tag) {
+    auto h = 31 - __builtin_clz(k);
+    auto l = (k ^ 1 << h) * (size_ >> h);
+    val_[k] = M::Apply(l, l + (size_ >> h) - 1, val_[k], tag);
+    if (k < size_) tag_[k] = M::Compose(tag, tag_[k]);
+  }
+
+  void Pull(int k) { val_[k] = M::Combine(val_[k << 1], val_[k << 1 | 1]); }
+
+  void Push(int k) {
+    if (tag_[k] == M::NoTag()) return;
+    Apply(k << 1, tag_[k]);
+    Apply(k << 1 | 1, tag_[k]);
+    tag_[k] = M::NoTag();
+  }
+
+  void PushBoundaries(int x, int y) {
+    for (int i = log_; i > 0; i--) {
+      if (((x >> i) << i) != x) Push(x >> i);
+      if (((y >> i) << i) != y) Push((y - 1) >> i);
+    }
+  }
+
+  int n_, log_, size_;
+  vector<Value> val_;
+  vector<Tag> tag_;
+};
+
+// Persistent lazy segment tree with the same Node concept as SegmentTree.
+// Every Update copies the nodes on its paths (and the children receiving
+// pushed tags) into a new version, older versions are never modified.
+// Nodes live in one pool addressed by 32-bit indices, `capacity` nodes are
+// reserved up front; an update allocates about 4 log n nodes
+template <typename T>
+class PersistentSegmentTree {
+ public:
+  explicit PersistentSegmentTree(int n, size_t capacity = 0) : n_(n) {
+    pool_.reserve(max(capacity, size_t(max(1, n_ * 2 - 1))));
+    roots_.push_back(Build(0, n_ - 1, [](T &, int) {}));
+  }
+
+  template <typename S>
+  PersistentSegmentTree(int n, const vector<S> &val, size_t capacity = 0)
+      : n_(n) {
+    pool_.reserve(max(capacity, size_t(max(1, n_ * 2 - 1))));
+    roots_.push_back(
+        Build(0, n_ - 1, [&](T &u, int i) { u.Apply(i, i, val[i]); }));
+  }
+
+  // apply `val` to all position in range [x, y] of `version`, returns the
+  // new version. The initial version is 0
+  template <typename S>
+  int Update(int version, int x, int y, const S &val) {
+    assert(0 <= x && x <= y && y < n_);
+    auto root = Clone(roots_[version]);
+    Update(root, 0, n_ - 1, x, y, val);
+    roots_.push_back(root);
+    return static_cast<int>(roots_.size()) - 1;
+  }
+
+  T Get(int version, int x, int y) const {
+    assert(0 <= x && x <= y && y < n_);
+    auto root = roots_[version];
+    return Get(pool_[root].node, root, 0, n_ - 1, x, y);
+  }
+
+  int Versions() const { return static_cast<int>(roots_.size()); }
+
+  size_t Nodes() const { return pool_.size(); }
+
+  // bytes used by the pool
+  size_t Memory() const { return pool_.capacity() * sizeof(Item); }
+
+ private:
+  struct Item {
+    T node;
+    uint32_t left, right;
+  };
+
+  // init(leaf, i) sets up the leaf of position i
+  template <typename F>
+  uint32_t Build(int l, int r, const F &init) {
+    auto k = static_cast<uint32_t>(pool_.size());
+    pool_.push_back({T(), 0, 0});
+    // an empty tree is a single node
+    if (l > r) return k;
+    if (l == r) {
+      init(pool_[k].node, l);
+      return k;
+    }
+    auto m = l + r >> 1;
+    auto left = Build(l, m, init);
+    auto right = Build(m + 1, r, init);
+    pool_[k].left = left, pool_[k].right = right;
+    pool_[k].node.Pull(l, r, pool_[left].node, pool_[right].node);
+    return k;
+  }
+
+  uint32_t Clone(uint32_t k) {
+    pool_.push_back(pool_[k]);
+    return static_cast<uint32_t>(pool_.size()) - 1;
+  }
+
+  // k is a node of the new version only, so it can be changed in place
+  template <typename S>
+  void Update(uint32_t k, int l, int r, int x, int y, const S &val) {
+    if (x <= l && r <= y) {
+      pool_[k].node.Apply(l, r, val);
+      return;
+    }
+    auto m = l + r >> 1;
+    auto left = Clone(pool_[k].left);
+    auto right = Clone(pool_[k].right);
+    pool_[k].left = left, pool_[k].right = right;
+    pool_[k].node.Push(l, r, pool_[left].node, pool_[right].node);
+    if (x <= m) Update(left, l, m, x, y, val);
+    if (y > m) Update(right, m + 1, r, x, y, val);
+    pool_[k].node.Pull(l, r, pool_[left].node, pool_[right].node);
+  }
+
+  // cur is node k with the tags of its ancestors applied, pushes are done
+  // on copies so the pool is left untouched
+  T Get(const T &cur, uint32_t k, int l, int r, int x, int y) const {
+    if (x <= l && r <= y) return cur;
+    auto m = l + r >> 1;
+    auto &item = pool_[k];
+    T node = cur, u = pool_[item.left].node, v = pool_[item.right].node;
+    node.Push(l, r, u, v);
+    if (y <= m) return Get(u, item.left, l, m, x, y);
+    if (x > m) return Get(v, item.right, m + 1, r, x, y);
+    T p1 = Get(u, item.left, l, m, x, y);
+    T p2 = Get(v, item.right, m + 1, r, x, y);
+    T res;
+    res.Pull(l, r, p1, p2);
+    return res;
+  }
+
+  int n_;
+  vector<Item> pool_;
+  vector<uint32_t> roots_;
+};
+
+// Segment tree over the coordinates [lo, hi] with nodes created on demand,
+// for ranges too large to allocate such as [0, 1e18]. It uses the Node
+// concept of SegmentTree with long long bounds, and a default T() must
+// stand for any range of untouched positions. Nodes are taken from one
+// arena addressed by 32-bit indices, each Update adds at most
+// 4 log(hi - lo + 1) nodes and Get adds none. Node bounds use l + r and
+// r - l + 1, so lo and hi must lie in (-2^62, 2^62)
+template <typename T>
+class DynamicSegmentTree {
+ public:
+  DynamicSegmentTree(long long lo, long long hi, size_t capacity = 0)
+      : lo_(lo), hi_(hi) {
+    assert(-LIMIT < lo_ && lo_ <= hi_ && hi_ < LIMIT);
+    arena_.reserve(max(capacity, size_t(2)));
+    arena_.push_back({T(), 0, 0});
+    arena_.push_back({T(), 0, 0});
+  }
+
+  // apply `val` to all position in range [x, y]
+  template <typename S>
+  void Update(long long x, long long y, const S &val) {
+    assert(lo_ <= x && x <= y && y <= hi_);
+    Update(ROOT, lo_, hi_, x, y, val);
+  }
+
+  T Get(long long x, long long y) const {
+    assert(lo_ <= x && x <= y && y <= hi_);
+    return Get(arena_[ROOT].node, ROOT, lo_, hi_, x, y);
+  }
+
+  size_t Nodes() const { return arena_.size(); }
+
+  // bytes used by the arena
+  size_t Memory() const { return arena_.capacity() * sizeof(Item); }
+
+ private:
+  // node 0 is an untouched node that is its own left and right child, it
+  // stands for every child that is not created yet
+  static constexpr uint32_t ROOT = 1;
+  static constexpr long long LIMIT = 1LL << 62;
+
+  struct Item {
+    T node;
+    uint32_t left, right;
+  };
+
+  void Expand(uint32_t k) {
+    if (arena_[k].left) return;
+    auto left = static_cast<uint32_t>(arena_.size());
+    arena_.push_back({T(), 0, 0});
+    arena_.push_back({T(), 0, 0});
+    arena_[k].left = left, arena_[k].right = left + 1;
+  }
+
+  template <typename S>
+  void Update(uint32_t k, long long l, long long r, long long x,
+              long long y, const S &val) {
+    if (x <= l && r <= y) {
+      arena_[k].node.Apply(l, r, val);
+      return;
+    }
+    auto m = l + r >> 1;
+    Expand(k);
+    auto left = arena_[k].left, right = arena_[k].right;
+    arena_[k].node.Push(l, r, arena_[left].node, arena_[right].node);
+    if (x <= m) Update(left, l, m, x, y, val);
+    if (y > m) Update(right, m + 1, r, x, y, val);
+    arena_[k].node.Pull(l, r, arena_[left].node, arena_[right].node);
+  }
+
+  // cur is node k with the tags of its ancestors applied, pushes are done
+  // on copies so the arena is left untouched
+  T Get(const T &cur, uint32_t k, long long l, long long r, long long x,
+        long long y) const {
+    if (x <= l && r <= y) return cur;
+    auto m = l + r >> 1;
+    auto &item = arena_[k];
+    T node = cur, u = arena_[item.left].node, v = arena_[item.right].node;
+    node.Push(l, r, u, v);
+    if (y <= m) return Get(u, item.left, l, m, x, y);
+    if (x > m) return Get(v, item.right, m + 1, r, x, y);
+    T p1 = Get(u, item.left, l, m, x, y);
+    T p2 = Get(v, item.right, m + 1, r, x, y);
+    T res;
+    res.Pull(l, r, p1, p2);
+    return res;
+  }
+
+  long long lo_, hi_;
+  vector<Item> arena_;
+};
+
+// SegmentTree for one writer thread and any number of reader threads,
+// kept as two copies with the left-right technique. Readers announce
+// themselves on the active copy and run the const Get on it, they never
+// wait for the writer. The writer updates the inactive copy and makes it
+// active; the same update is replayed on the other copy at the start of the
+// next Update, once the readers still on it are gone. Every Get sees the
+// tree after some whole number of updates
+template <typename T>
+class ConcurrentSegmentTree {
+ public:
+  explicit ConcurrentSegmentTree(int n)
+      : trees_{SegmentTree<T>(n), SegmentTree<T>(n)} {}
+
+  template <typename S>
+  ConcurrentSegmentTree(int n, const vector<S> &val)
+      : trees_{SegmentTree<T>(n, val), SegmentTree<T>(n, val)} {}
+
+  // apply `val` to all position in range [x, y], writer thread only
+  template <typename S>
+  void Update(int x, int y, const S &val) {
+    int side = !active_.load();
+    while (readers_[side].count.load()) this_thread::yield();
+    if (replay_) replay_(trees_[side]);
+    trees_[side].Update(x, y, val);
+    active_.store(side);
+    replay_ = [=](SegmentTree<T> &tree) { tree.Update(x, y, val); };
+  }
+
+  // any thread
+  T Get(int x, int y) const {
+    int side;
+    while (true) {
+      side = active_.load();
+      readers_[side].count++;
+      // the writer may have switched sides before it saw this reader
+      if (active_.load() == side) break;
+      readers_[side].count--;
+    }
+    auto res = static_cast<const SegmentTree<T> &>(trees_[side]).Get(x, y);
+    readers_[side].count--;
+    return res;
+  }
+
+ private:
+  // own cache line each, so readers of one side do not slow the other
+  struct alignas(64) Counter {
+    atomic<int> count{0};
+  };
+
+  SegmentTree<T> trees_[2];
+  atomic<int> active_{0};
+  mutable Counter readers_[2];
+  // last update, not yet applied to the inactive copy
+  function<void(SegmentTree<T> &)> replay_;
+};
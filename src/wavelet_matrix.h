@@ -0,0 +1,151 @@
+#include "all.h"
+#include <optional>
+
+// Static bit vector with O(1) rank. Every 64 bits are stored as two
+// 32-bit halves next to the count of ones before them, so a rank reads a
+// single 12-byte block and the whole vector takes n * 1.5 bits
+class BitVector {
+ public:
+  explicit BitVector(int n) : blocks_((n >> 6) + 1) {}
+
+  void Set(int i) {
+    auto &block = blocks_[i >> 6];
+    (i & 32 ? block.high : block.low) |= 1U << (i & 31);
+  }
+
+  // call once after the last Set
+  void Build() {
+    for (int i = 1; i < blocks_.size(); i++) {
+      blocks_[i].rank = blocks_[i - 1].rank +
+                        __builtin_popcountll(blocks_[i - 1].Word());
+    }
+  }
+
+  bool Get(int i) const { return blocks_[i >> 6].Word() >> (i & 63) & 1; }
+
+  // number of ones in [0, i)
+  int Rank1(int i) const {
+    auto &block = blocks_[i >> 6];
+    return block.rank +
+           __builtin_popcountll(block.Word() & ((1ULL << (i & 63)) - 1));
+  }
+
+  int Rank0(int i) const { return i - Rank1(i); }
+
+ private:
+  struct Block {
+    uint32_t rank = 0, low = 0, high = 0;
+    uint64_t Word() const { return static_cast<uint64_t>(high) << 32 | low; }
+  };
+
+  vector<Block> blocks_;
+};
+
+// Wavelet matrix over a static array for order statistics on ranges.
+// Values are compressed to [0, sigma) and every level stores one bit of
+// them, highest bit first, with the values of the next level stably
+// sorted by that bit. All queries are O(log sigma) with n log sigma bit
+// vectors. Ranges [l, r] are inclusive
+template <typename T>
+class WaveletMatrix {
+ public:
+  explicit WaveletMatrix(const vector<T> &a)
+      : n_(static_cast<int>(a.size())), vals_(a) {
+    sort(vals_.begin(), vals_.end());
+    vals_.erase(unique(vals_.begin(), vals_.end()), vals_.end());
+    auto sigma = static_cast<int>(vals_.size());
+    log_ = sigma <= 1 ? 1 : 32 - __builtin_clz(sigma - 1);
+    vector<int> cur(n_), next(n_);
+    for (int i = 0; i < n_; i++) cur[i] = Compress(a[i]);
+    levels_.assign(log_, BitVector(n_));
+    zeros_.assign(log_, 0);
+    for (int level = 0; level < log_; level++) {
+      auto bit = log_ - 1 - level;
+      for (int i = 0; i < n_; i++) {
+        if (cur[i] >> bit & 1) {
+          levels_[level].Set(i);
+        } else {
+          zeros_[level]++;
+        }
+      }
+      levels_[level].Build();
+      auto zero = 0, one = zeros_[level];
+      for (int i = 0; i < n_; i++) {
+        (cur[i] >> bit & 1 ? next[one++] : next[zero++]) = cur[i];
+      }
+      swap(cur, next);
+    }
+  }
+
+  // k-th (0-indexed) smallest value in [l, r]
+  T KthSmallest(int l, int r, int k) const {
+    assert(0 <= l && l <= r && r < n_ && 0 <= k && k <= r - l);
+    r++;
+    auto res = 0;
+    for (int level = 0; level < log_; level++) {
+      auto l0 = levels_[level].Rank0(l), r0 = levels_[level].Rank0(r);
+      if (k < r0 - l0) {
+        l = l0, r = r0;
+      } else {
+        k -= r0 - l0;
+        res |= 1 << log_ - 1 - level;
+        l = zeros_[level] + l - l0, r = zeros_[level] + r - r0;
+      }
+    }
+    return vals_[res];
+  }
+
+  // number of values < upper in [l, r]
+  int RangeFreq(int l, int r, const T &upper) const {
+    assert(0 <= l && l <= r && r < n_);
+    return CountLess(l, r + 1, Compress(upper));
+  }
+
+  // number of values in [lower, upper) in [l, r]
+  int RangeFreq(int l, int r, const T &lower, const T &upper) const {
+    if (!(lower < upper)) return 0;
+    return RangeFreq(l, r, upper) - RangeFreq(l, r, lower);
+  }
+
+  // largest value < upper in [l, r]
+  optional<T> PrevValue(int l, int r, const T &upper) const {
+    auto cnt = RangeFreq(l, r, upper);
+    if (cnt == 0) return nullopt;
+    return KthSmallest(l, r, cnt - 1);
+  }
+
+  // smallest value >= lower in [l, r]
+  optional<T> NextValue(int l, int r, const T &lower) const {
+    auto cnt = RangeFreq(l, r, lower);
+    if (cnt == r - l + 1) return nullopt;
+    return KthSmallest(l, r, cnt);
+  }
+
+ private:
+  // number of distinct values < x
+  int Compress(const T &x) const {
+    return static_cast<int>(lower_bound(vals_.begin(), vals_.end(), x) -
+                            vals_.begin());
+  }
+
+  // number of compressed values < c in [l, r)
+  int CountLess(int l, int r, int c) const {
+    if (c >= 1 << log_) return r - l;
+    auto res = 0;
+    for (int level = 0; level < log_; level++) {
+      auto l0 = levels_[level].Rank0(l), r0 = levels_[level].Rank0(r);
+      if (c >> log_ - 1 - level & 1) {
+        res += r0 - l0;
+        l = zeros_[level] + l - l0, r = zeros_[level] + r - r0;
+      } else {
+        l = l0, r = r0;
+      }
+    }
+    return res;
+  }
+
+  int n_, log_;
+  vector<T> vals_;
+  vector<BitVector> levels_;
+  vector<int> zeros_;
+};
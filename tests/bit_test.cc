@@ -72,3 +72,85 @@ TEST(BitTest, SingleGet) {
   SingleGet<int>();
   SingleGet<Modular<127>>();
 }
+
+TEST(BitTest, LowerBound) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    BIT<long long> t(n);
+    vector<long long> prefix(n);
+    for (int i = 0; i < n; i++) {
+      int val = rng() % 3;
+      t.Add(i, val);
+      prefix[i] = (i ? prefix[i - 1] : 0) + val;
+    }
+    for (int k = -1; k <= prefix.back() + 1; k++) {
+      EXPECT_EQ(lower_bound(prefix.begin(), prefix.end(), k) - prefix.begin(),
+                t.LowerBound(k));
+    }
+  }
+}
+
+template <typename T>
+void RangeAddRangeSum() {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    RangeBIT<T> t(n);
+    int tc = rng() % N + 1;
+    vector<T> a(n);
+    while (tc--) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        T val(rng() % N - N / 2);
+        t.Add(l, r, val);
+        for (int i = l; i <= r; i++) {
+          a[i] += val;
+        }
+      } else {
+        T res(0);
+        for (int i = l; i <= r; i++) {
+          res += a[i];
+        }
+        EXPECT_EQ(res, t.Get(l, r));
+      }
+    }
+  }
+}
+
+TEST(BitTest, RangeAddRangeSum) {
+  RangeAddRangeSum<int>();
+  RangeAddRangeSum<Modular<127>>();
+}
+
+template <typename T>
+void InitToArray() {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    vector<T> a(n);
+    for (auto &u : a) {
+      u = T(rng() % N - N / 2);
+    }
+    BIT<T> t(a), slow(n);
+    for (int i = 0; i < n; i++) {
+      slow.Add(i, a[i]);
+    }
+    for (int i = 0; i < n; i++) {
+      EXPECT_EQ(slow.Get(i), t.Get(i));
+    }
+    EXPECT_EQ(a, t.ToArray());
+    int pos = rng() % n;
+    T val(rng() % N);
+    t.Add(pos, val);
+    a[pos] += val;
+    EXPECT_EQ(a, t.ToArray());
+    t.Reset();
+    EXPECT_EQ(vector<T>(n, T(0)), t.ToArray());
+    EXPECT_EQ(T(0), t.Get(0, n - 1));
+  }
+}
+
+TEST(BitTest, InitToArray) {
+  InitToArray<int>();
+  InitToArray<Modular<127>>();
+}
@@ -87,3 +87,185 @@ TEST(BitwiseFFTTest, AND) {
     EXPECT_EQ(c, d);
   }
 }
+
+template <typename T>
+vector<T> SubsetConvolution(const vector<T> &a, const vector<T> &b) {
+  assert(IsPowerOfTwo(a.size()));
+  assert(IsPowerOfTwo(b.size()));
+  assert(a.size() == b.size());
+  vector<T> res(a.size());
+  for (int i = 0; i < a.size(); i++) {
+    for (int j = i;; j = (j - 1) & i) {
+      res[i] += a[j] * b[i ^ j];
+      if (!j) break;
+    }
+  }
+  return res;
+}
+
+TEST(BitwiseFFTTest, Subset) {
+  for (int it = 0; it <= 10; it++) {
+    int n = 1 << it;
+    vector<Mint> a(n);
+    for (auto &u : a) u = Mint(rng() % MOD);
+    vector<Mint> b(n);
+    for (auto &u : b) u = Mint(rng() % MOD);
+    auto c = SubsetConvolution(a, b);
+    auto d = fft::SubsetConvolution(a, b);
+    EXPECT_EQ(c, d);
+  }
+}
+
+// Level by level transforms, to check the blocked ones on large sizes
+template <typename T>
+void NaiveFFT(vector<T> &a, int type) {
+  auto n = static_cast<int>(a.size());
+  for (int i = 1; i < n; i <<= 1) {
+    for (int j = 0; j < n; j++) {
+      if (j & i) continue;
+      T u = a[j], v = a[i + j];
+      if (type == 0) a[j] = u + v, a[i + j] = u - v;
+      if (type == 1) a[j] = u + v, a[i + j] = u;
+      if (type == 2) a[j] = v, a[i + j] = u + v;
+    }
+  }
+}
+
+TEST(BitwiseFFTTest, Large) {
+  for (int it : {12, 13, 14, 15}) {
+    int n = 1 << it;
+    vector<Mint> a(n);
+    for (auto &u : a) u = Mint(rng() % MOD);
+    for (int type = 0; type < 3; type++) {
+      auto b = a, c = a;
+      NaiveFFT(b, type);
+      if (type == 0) fft::XorFFT(c, 0);
+      if (type == 1) fft::OrFFT(c, 0);
+      if (type == 2) fft::AndFFT(c, 0);
+      EXPECT_EQ(b, c);
+      if (type == 0) fft::XorFFT(c, 1);
+      if (type == 1) fft::OrFFT(c, 1);
+      if (type == 2) fft::AndFFT(c, 1);
+      EXPECT_EQ(a, c);
+    }
+  }
+}
+
+TEST(BitwiseFFTTest, Parallel) {
+  for (int it : {0, 1, 3, 12, 14}) {
+    int n = 1 << it;
+    vector<Mint> a(n);
+    for (auto &u : a) u = Mint(rng() % MOD);
+    vector<Mint> b(n);
+    for (auto &u : b) u = Mint(rng() % MOD);
+    auto x = fft::XorConvolution(a, b);
+    auto o = fft::OrConvolution(a, b);
+    auto y = fft::AndConvolution(a, b);
+    for (int threads = 2; threads <= 8; threads++) {
+      EXPECT_EQ(x, fft::XorConvolution(a, b, threads));
+      EXPECT_EQ(o, fft::OrConvolution(a, b, threads));
+      EXPECT_EQ(y, fft::AndConvolution(a, b, threads));
+    }
+  }
+}
+
+TEST(BitwiseFFTTest, XorInPlace) {
+  for (int it = 0; it <= 10; it++) {
+    int n = 1 << it;
+    vector<Mint> a(n);
+    for (auto &u : a) u = Mint(rng() % MOD);
+    vector<Mint> b(n);
+    for (auto &u : b) u = Mint(rng() % MOD);
+    auto c = XorConvolution(a, b);
+    auto d = XorConvolution(a, a);
+    auto e = a;
+    fft::XorConvolutionInPlace(e, e);
+    EXPECT_EQ(d, e);
+    fft::XorConvolutionInPlace(b, a);
+    EXPECT_EQ(c, b);
+
+    vector<int64_t> x(n);
+    for (auto &u : x) u = int64_t(rng() % 2000) - 1000;
+    vector<int64_t> y(n);
+    for (auto &u : y) u = int64_t(rng() % 2000) - 1000;
+    auto z = XorConvolution(x, y);
+    auto w = XorConvolution(x, x);
+    EXPECT_EQ(z, fft::XorConvolution(x, y));
+    fft::XorConvolutionInPlace(x, x);
+    EXPECT_EQ(w, x);
+  }
+}
+
+template <typename T>
+vector<T> KaryXorConvolution(const vector<T> &a, const vector<T> &b, int k) {
+  assert(a.size() == b.size());
+  vector<T> res(a.size());
+  for (int i = 0; i < a.size(); i++) {
+    for (int j = 0; j < b.size(); j++) {
+      int s = 0;
+      for (int x = i, y = j, p = 1; x || y; x /= k, y /= k, p *= k) {
+        s += (x % k + y % k) % k * p;
+      }
+      res[s] += a[i] * b[j];
+    }
+  }
+  return res;
+}
+
+TEST(BitwiseFFTTest, Kary) {
+  for (int k : {2, 3, 5, 7}) {
+    for (int n = 1; n <= 2000; n *= k) {
+      vector<Mint> a(n);
+      for (auto &u : a) u = Mint(rng() % MOD);
+      vector<Mint> b(n);
+      for (auto &u : b) u = Mint(rng() % MOD);
+      auto c = KaryXorConvolution(a, b, k);
+      auto d = fft::KaryXorConvolution(a, b, k);
+      EXPECT_EQ(c, d);
+    }
+  }
+  // 754974721 - 1 = 45 * 2^24 has 3rd and 5th roots of unity
+  using Mod = Modular<754974721>;
+  for (int k : {3, 5}) {
+    for (int n = 1; n <= 2000; n *= k) {
+      vector<Mod> a(n), b(n);
+      for (auto &u : a) u = Mod(rng());
+      for (auto &u : b) u = Mod(rng());
+      EXPECT_EQ(KaryXorConvolution(a, b, k), fft::KaryXorConvolution(a, b, k));
+      auto c = a;
+      fft::KaryFFT(c, k, Mod::RootOfUnity(k), 0);
+      fft::KaryFFT(c, k, Mod::RootOfUnity(k), 1);
+      EXPECT_EQ(a, c);
+    }
+  }
+  // beyond one block: convolving with a unit at z shifts a by z digit-wise
+  int n = 19683, z = rng() % n;
+  vector<Mint> a(n), b(n), c(n);
+  for (auto &u : a) u = Mint(rng() % MOD);
+  b[z] = Mint(1);
+  for (int i = 0; i < n; i++) {
+    int s = 0;
+    for (int x = i, y = z, p = 1; x || y; x /= 3, y /= 3, p *= 3) {
+      s += (x % 3 + y % 3) % 3 * p;
+    }
+    c[s] = a[i];
+  }
+  EXPECT_EQ(c, fft::KaryXorConvolution(a, b, 3));
+}
+
+TEST(BitwiseFFTTest, GcdLcm) {
+  for (int n = 1; n <= 200; n += rng() % 10 + 1) {
+    vector<Mint> a(n + 1), b(n + 1);
+    for (int i = 1; i <= n; i++) a[i] = Mint(rng() % MOD);
+    for (int i = 1; i <= n; i++) b[i] = Mint(rng() % MOD);
+    vector<Mint> gcd(n + 1), lcm(n + 1);
+    for (int i = 1; i <= n; i++) {
+      for (int j = 1; j <= n; j++) {
+        gcd[__gcd(i, j)] += a[i] * b[j];
+        if (i / __gcd(i, j) * j <= n) lcm[i / __gcd(i, j) * j] += a[i] * b[j];
+      }
+    }
+    EXPECT_EQ(gcd, fft::GcdConvolution(a, b));
+    EXPECT_EQ(lcm, fft::LcmConvolution(a, b));
+  }
+}
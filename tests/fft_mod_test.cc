@@ -128,3 +128,43 @@ TEST_F(FftModTest, Size) {
     EXPECT_EQ(Naive(a, b), fft_double_.Mult(a, b));
   }
 }
+
+TEST_F(FftModTest, Square) {
+  for (int it = 0; it < 100; it++) {
+    int n = rng() % 100 + 1;
+    vector<Mint> a(n);
+    for (auto &u : a) {
+      u = Mint(rng() % MOD);
+    }
+    EXPECT_EQ(Naive(a, a), fft_double_.Square(a));
+  }
+}
+
+// Long outputs use the 3-way split; check C(x) = A(x) * B(x) at random x
+TEST_F(FftModTest, Split3) {
+  using Mint = Modular<1'000'000'007>;
+  auto eval = [](const vector<Mint> &p, Mint x) {
+    Mint res(0);
+    for (int i = static_cast<int>(p.size()) - 1; i >= 0; i--) {
+      res = res * x + p[i];
+    }
+    return res;
+  };
+  int n = FFT<double>::SPLIT3_MIN_SIZE / 2 + 1;
+  vector<Mint> a(n), b(n + 1);
+  for (auto &u : a) {
+    u = Mint(rng() % 1'000'000'007);
+  }
+  for (auto &u : b) {
+    u = Mint(rng() % 1'000'000'007);
+  }
+  auto c = fft_double_.Mult(a, b);
+  auto d = fft_double_.Square(a);
+  ASSERT_EQ(a.size() + b.size() - 1, c.size());
+  ASSERT_EQ(a.size() * 2 - 1, d.size());
+  for (int it = 0; it < 10; it++) {
+    Mint x(rng() % 1'000'000'007);
+    EXPECT_EQ(eval(a, x) * eval(b, x), eval(c, x));
+    EXPECT_EQ(eval(a, x) * eval(a, x), eval(d, x));
+  }
+}
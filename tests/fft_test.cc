@@ -119,3 +119,146 @@ TEST_F(FftTest, Size) {
     EXPECT_EQ(Naive(a, b), fft_double_.Mult(a, b));
   }
 }
+
+TEST_F(FftTest, Bluestein) {
+  for (int n = 1; n <= 50; n++) {
+    vector<complex<double>> a(n);
+    for (auto &u : a) u = complex<double>(rng() % 1000, rng() % 1000);
+    auto b = a;
+    fft_double_.BluesteinDFT(b, false);
+    double PI = acos(-1.0);
+    for (int k = 0; k < n; k++) {
+      complex<double> expected = 0;
+      for (int j = 0; j < n; j++) {
+        expected += a[j] * polar(1.0, 2 * PI * (1ll * j * k % n) / n);
+      }
+      EXPECT_NEAR(expected.real(), b[k].real(), 1e-6);
+      EXPECT_NEAR(expected.imag(), b[k].imag(), 1e-6);
+    }
+    fft_double_.BluesteinDFT(b, true);
+    for (int i = 0; i < n; i++) {
+      EXPECT_NEAR(a[i].real(), b[i].real(), 1e-6);
+      EXPECT_NEAR(a[i].imag(), b[i].imag(), 1e-6);
+    }
+  }
+}
+
+TEST_F(FftTest, CyclicConvolve) {
+  for (int it = 0; it < 100; it++) {
+    int n = rng() % 100 + 1;
+    int sa = rng() % 150 + 1;
+    int sb = rng() % 150 + 1;
+    vector<int64_t> a(sa), b(sb);
+    for (auto &u : a) {
+      u = rng() % 2'000'000 - 1'000'000;
+    }
+    for (auto &u : b) {
+      u = rng() % 2'000'000 - 1'000'000;
+    }
+    vector<int64_t> expected(n);
+    for (int i = 0; i < sa; i++) {
+      for (int j = 0; j < sb; j++) {
+        expected[(i + j) % n] += a[i] * b[j];
+      }
+    }
+    EXPECT_EQ(expected, fft_double_.CyclicConvolve(a, b, n));
+  }
+}
+
+// prime n, checked against the product of size n BluesteinDFTs
+TEST_F(FftTest, CyclicConvolveLarge) {
+  const int n = 30011;
+  vector<int64_t> a(n), b(n);
+  vector<complex<double>> fa(n), fb(n);
+  for (int i = 0; i < n; i++) {
+    fa[i] = a[i] = rng() % 1000;
+    fb[i] = b[i] = rng() % 1000;
+  }
+  fft_double_.BluesteinDFT(fa, false);
+  fft_double_.BluesteinDFT(fb, false);
+  for (int i = 0; i < n; i++) fa[i] *= fb[i];
+  fft_double_.BluesteinDFT(fa, true);
+  vector<int64_t> expected(n);
+  for (int i = 0; i < n; i++) expected[i] = llround(fa[i].real());
+  EXPECT_EQ(expected, fft_double_.CyclicConvolve(a, b, n));
+}
+
+TEST_F(FftTest, CrossCorrelate) {
+  EXPECT_EQ(vector<int64_t>{},
+            fft_double_.CrossCorrelate(vector<int64_t>{1}, vector<int64_t>{}));
+  EXPECT_EQ(vector<int64_t>{}, fft_double_.CrossCorrelate(
+                                   vector<int64_t>{1}, vector<int64_t>{1, 2}));
+  for (int it = 0; it < 100; it++) {
+    int n = rng() % 100 + 1;
+    int m = rng() % n + 1;
+    vector<int64_t> text(n), pattern(m);
+    for (auto &u : text) {
+      u = rng() % 2'000'000 - 1'000'000;
+    }
+    for (auto &u : pattern) {
+      u = rng() % 2'000'000 - 1'000'000;
+    }
+    vector<int64_t> expected(n - m + 1);
+    for (int i = 0; i + m <= n; i++) {
+      for (int j = 0; j < m; j++) {
+        expected[i] += text[i + j] * pattern[j];
+      }
+    }
+    EXPECT_EQ(expected, fft_double_.CrossCorrelate(text, pattern));
+  }
+}
+
+TEST_F(FftTest, Parallel) {
+  FFT<double> parallel;
+  for (int threads = 1; threads <= 8; threads++) {
+    parallel.SetThreads(threads, 1);
+    for (int n = 1; n <= 1 << 12; n <<= 1) {
+      vector<complex<double>> a(n);
+      for (auto &u : a) u = complex<double>(rng() % 1000, rng() % 1000);
+      auto b = a;
+      fft_double_.DFT(a, false);
+      parallel.DFT(b, false);
+      EXPECT_EQ(a, b);
+      fft_double_.DFT(a, true);
+      parallel.DFT(b, true);
+      EXPECT_EQ(a, b);
+    }
+  }
+  vector<int64_t> a(N), b(N);
+  for (auto &u : a) {
+    u = rng() % 4'000'000 - 2'000'000;
+  }
+  for (auto &u : b) {
+    u = rng() % 2'000'000 - 1'000'000;
+  }
+  EXPECT_EQ(Naive(a, b), parallel.Mult(a, b));
+}
+
+TEST_F(FftTest, Mult2D) {
+  EXPECT_EQ(vector<vector<int64_t>>{},
+            fft_double_.Mult2D(vector<vector<int64_t>>{},
+                               vector<vector<int64_t>>{{1}}));
+  for (int it = 0; it < 100; it++) {
+    int n = rng() % 20 + 1, m = rng() % 20 + 1;
+    int p = rng() % 20 + 1, q = rng() % 20 + 1;
+    vector<vector<int64_t>> a(n, vector<int64_t>(m));
+    vector<vector<int64_t>> b(p, vector<int64_t>(q));
+    for (auto &row : a) {
+      for (auto &u : row) u = rng() % 2'000'000 - 1'000'000;
+    }
+    for (auto &row : b) {
+      for (auto &u : row) u = rng() % 2'000'000 - 1'000'000;
+    }
+    vector<vector<int64_t>> expected(n + p - 1, vector<int64_t>(m + q - 1));
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        for (int x = 0; x < p; x++) {
+          for (int y = 0; y < q; y++) {
+            expected[i + x][j + y] += a[i][j] * b[x][y];
+          }
+        }
+      }
+    }
+    EXPECT_EQ(expected, fft_double_.Mult2D(a, b));
+  }
+}
@@ -0,0 +1,213 @@
+#include <../src/hld.h>
+#include <gtest/gtest.h>
+
+const int N = 100;
+
+mt19937 rng;
+
+// random tree with shuffled labels, `path` makes it close to a path
+vector<vector<int>> RandomTree(int n, bool path) {
+  vector<int> label(n);
+  iota(label.begin(), label.end(), 0);
+  shuffle(label.begin(), label.end(), rng);
+  vector<vector<int>> adj(n);
+  for (int i = 1; i < n; i++) {
+    int p = path ? max(0, i - 1 - static_cast<int>(rng() % 2)) : rng() % i;
+    adj[label[i]].push_back(label[p]);
+    adj[label[p]].push_back(label[i]);
+  }
+  return adj;
+}
+
+struct Naive {
+  Naive(const vector<vector<int>> &adj, int root)
+      : parent(adj.size(), -1), depth(adj.size()) {
+    vector<int> order = {root};
+    for (int i = 0; i < order.size(); i++) {
+      for (auto v : adj[order[i]]) {
+        if (v == parent[order[i]]) continue;
+        parent[v] = order[i];
+        depth[v] = depth[order[i]] + 1;
+        order.push_back(v);
+      }
+    }
+  }
+
+  // vertices of the path u-v, without the top one if edges
+  vector<int> Path(int u, int v, bool edges) const {
+    vector<int> res;
+    while (u != v) {
+      if (depth[u] < depth[v]) swap(u, v);
+      res.push_back(u);
+      u = parent[u];
+    }
+    if (!edges) res.push_back(u);
+    return res;
+  }
+
+  // vertices of the path u-v in order from u to v
+  vector<int> OrderedPath(int u, int v, bool edges) const {
+    vector<int> up, down;
+    while (u != v) {
+      if (depth[u] >= depth[v]) {
+        up.push_back(u);
+        u = parent[u];
+      } else {
+        down.push_back(v);
+        v = parent[v];
+      }
+    }
+    if (!edges) up.push_back(u);
+    up.insert(up.end(), down.rbegin(), down.rend());
+    return up;
+  }
+
+  bool InSubtree(int u, int v) const {
+    for (; u != -1; u = parent[u]) {
+      if (u == v) return true;
+    }
+    return false;
+  }
+
+  vector<int> parent, depth;
+};
+
+void RandomTest(bool path, bool edges) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int root = rng() % n;
+    auto adj = RandomTree(n, path);
+    HLD hld(adj, root);
+    Naive naive(adj, root);
+    vector<long long> a(n);
+    for (auto &u : a) {
+      u = rng() % N;
+    }
+    SegmentTree<Node<long long>> t(n, hld.Permute(a));
+    for (int tc = 0; tc < N; tc++) {
+      int u = rng() % n;
+      int v = rng() % n;
+      long long val = rng() % N - N / 2;
+      auto vertices = naive.Path(u, v, edges);
+      switch (rng() % 4) {
+        case 0: {
+          hld.PathUpdate(t, u, v, val, edges);
+          for (auto w : vertices) {
+            a[w] += val;
+          }
+          break;
+        }
+        case 1: {
+          long long res = 0;
+          for (auto w : vertices) {
+            res += a[w];
+          }
+          EXPECT_EQ(res, hld.PathQuery(t, u, v, edges).sum);
+          break;
+        }
+        case 2: {
+          hld.SubtreeUpdate(t, u, val);
+          for (int w = 0; w < n; w++) {
+            if (naive.InSubtree(w, u)) a[w] += val;
+          }
+          break;
+        }
+        default: {
+          long long res = 0;
+          for (int w = 0; w < n; w++) {
+            if (naive.InSubtree(w, u)) res += a[w];
+          }
+          EXPECT_EQ(res, hld.SubtreeQuery(t, u).sum);
+        }
+      }
+    }
+  }
+}
+
+TEST(HldTest, RandomTree) {
+  RandomTest(false, false);
+  RandomTest(false, true);
+}
+
+TEST(HldTest, PathTree) {
+  RandomTest(true, false);
+  RandomTest(true, true);
+}
+
+// labels of a range in position order, Pull is not commutative
+struct Labels {
+  static Labels worst() { return Labels(); }
+
+  void Apply(long long l, long long r, char c) { s.assign(r - l + 1, c); }
+
+  void Pull(long long l, long long r, const Labels &u, const Labels &v) {
+    s = u.s + v.s;
+  }
+
+  void Push(long long l, long long r, Labels &u, Labels &v) {}
+
+  void Reverse() { reverse(s.begin(), s.end()); }
+
+  string s;
+};
+
+TEST(HldTest, NonCommutative) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int root = rng() % n;
+    auto adj = RandomTree(n, rng() % 2);
+    HLD hld(adj, root);
+    Naive naive(adj, root);
+    string a(n, 'a');
+    for (auto &c : a) {
+      c = 'a' + rng() % 26;
+    }
+    SegmentTree<Labels> t(n, hld.Permute(vector<char>(a.begin(), a.end())));
+    for (int tc = 0; tc < N; tc++) {
+      int u = rng() % n;
+      int v = rng() % n;
+      if (rng() % 2) {
+        a[u] = 'a' + rng() % 26;
+        t.Update(hld.Pos(u), hld.Pos(u), a[u]);
+        continue;
+      }
+      bool edges = rng() % 2;
+      string res;
+      for (auto w : naive.OrderedPath(u, v, edges)) {
+        res += a[w];
+      }
+      EXPECT_EQ(res, hld.PathQuery(t, u, v, edges).s);
+    }
+  }
+}
+
+TEST(HldTest, Lca) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int root = rng() % n;
+    auto adj = RandomTree(n, rng() % 2);
+    HLD hld(adj, root);
+    Naive naive(adj, root);
+    for (int tc = 0; tc < N; tc++) {
+      int u = rng() % n;
+      int v = rng() % n;
+      int w = naive.Path(u, v, false).back();
+      EXPECT_EQ(w, hld.Lca(u, v));
+    }
+  }
+}
+
+TEST(HldTest, DeepPath) {
+  const int n = 1000000;
+  vector<vector<int>> adj(n);
+  for (int i = 1; i < n; i++) {
+    adj[i - 1].push_back(i);
+    adj[i].push_back(i - 1);
+  }
+  HLD hld(adj);
+  SegmentTree<NodeMax<int>> t(n);
+  hld.PathUpdate(t, n - 1, n / 2, 1);
+  EXPECT_EQ(0, hld.PathQuery(t, 0, n / 2 - 1).max_val);
+  EXPECT_EQ(1, hld.SubtreeQuery(t, n / 3).max_val);
+  EXPECT_EQ(n / 2, hld.Lca(n / 2, n - 1));
+}
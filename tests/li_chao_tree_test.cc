@@ -0,0 +1,112 @@
+#include <../src/li_chao_tree.h>
+#include <gtest/gtest.h>
+
+const int N = 100;
+const long long INF = numeric_limits<long long>::max();
+
+mt19937 rng;
+mt19937_64 rng_64;
+
+struct Segment {
+  long long a, b, x1, x2;
+};
+
+long long Naive(const vector<Segment> &segments, long long x) {
+  auto res = INF;
+  for (auto [a, b, x1, x2] : segments) {
+    if (x1 <= x && x <= x2) res = min(res, a * x + b);
+  }
+  return res;
+}
+
+TEST(LiChaoTreeTest, Empty) {
+  LiChaoTree<long long> t({5, -3});
+  EXPECT_EQ(INF, t.Get(5));
+  DynamicLiChaoTree<long long> d(-10, 10);
+  EXPECT_EQ(INF, d.Get(0));
+}
+
+TEST(LiChaoTreeTest, Lines) {
+  LiChaoTree<long long> t({-2, 0, 1, 3});
+  t.AddLine(1, 0);
+  t.AddLine(-1, 1);
+  EXPECT_EQ(-2, t.Get(-2));
+  EXPECT_EQ(0, t.Get(0));
+  EXPECT_EQ(0, t.Get(1));
+  EXPECT_EQ(-2, t.Get(3));
+}
+
+TEST(LiChaoTreeTest, RandomTest) {
+  for (int it = 0; it < N; it++) {
+    int range = rng() % N + 1;
+    vector<long long> xs(rng() % N + 1);
+    for (auto &x : xs) {
+      x = static_cast<int>(rng() % range) - range / 2;
+    }
+    LiChaoTree<long long> t(xs);
+    DynamicLiChaoTree<long long> d(-range, range);
+    vector<Segment> segments;
+    for (int tc = 0; tc < N; tc++) {
+      long long a = static_cast<int>(rng() % N) - N / 2;
+      long long b = static_cast<int>(rng() % (N * N)) - N * N / 2;
+      if (rng() % 2) {
+        t.AddLine(a, b);
+        d.AddLine(a, b);
+        segments.push_back({a, b, -range, range});
+      } else {
+        long long x1 = static_cast<int>(rng() % (range * 2 + 1)) - range;
+        long long x2 = static_cast<int>(rng() % (range * 2 + 1)) - range;
+        if (x1 > x2) swap(x1, x2);
+        t.AddSegment(a, b, x1, x2);
+        d.AddSegment(a, b, x1, x2);
+        segments.push_back({a, b, x1, x2});
+      }
+      auto x = xs[rng() % xs.size()];
+      EXPECT_EQ(Naive(segments, x), t.Get(x));
+      x = static_cast<int>(rng() % (range * 2 + 1)) - range;
+      EXPECT_EQ(Naive(segments, x), d.Get(x));
+    }
+  }
+}
+
+TEST(LiChaoTreeTest, DynamicLarge) {
+  const long long MAX = 1e18;
+  DynamicLiChaoTree<long long> d(-MAX, MAX);
+  vector<Segment> segments;
+  for (int it = 0; it < N * 10; it++) {
+    long long a = static_cast<int>(rng() % 7) - 3;
+    long long b = static_cast<long long>(rng_64() % (MAX * 2)) - MAX;
+    long long x1 = static_cast<long long>(rng_64() % (MAX * 2 + 1)) - MAX;
+    long long x2 = static_cast<long long>(rng_64() % (MAX * 2 + 1)) - MAX;
+    if (x1 > x2) swap(x1, x2);
+    if (rng() % 2) {
+      d.AddLine(a, b);
+      segments.push_back({a, b, -MAX, MAX});
+    } else {
+      d.AddSegment(a, b, x1, x2);
+      segments.push_back({a, b, x1, x2});
+    }
+    auto x = static_cast<long long>(rng_64() % (MAX * 2 + 1)) - MAX;
+    EXPECT_EQ(Naive(segments, x), d.Get(x));
+  }
+  EXPECT_LE(d.Nodes(), 2 + segments.size() * 2 * 62);
+}
+
+// the whole long long range, with horizontal segments so nothing overflows
+TEST(LiChaoTreeTest, DynamicFullRange) {
+  const long long LOW = numeric_limits<long long>::min();
+  DynamicLiChaoTree<long long> d(LOW, INF);
+  vector<Segment> segments;
+  for (int it = 0; it < N * 10; it++) {
+    long long b = static_cast<long long>(rng_64());
+    long long x1 = static_cast<long long>(rng_64());
+    long long x2 = static_cast<long long>(rng_64());
+    if (x1 > x2) swap(x1, x2);
+    d.AddSegment(0, b, x1, x2);
+    segments.push_back({0, b, x1, x2});
+    auto x = static_cast<long long>(rng_64());
+    EXPECT_EQ(Naive(segments, x), d.Get(x));
+    EXPECT_EQ(Naive(segments, LOW), d.Get(LOW));
+    EXPECT_EQ(Naive(segments, INF), d.Get(INF));
+  }
+}
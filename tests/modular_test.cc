@@ -51,6 +51,16 @@ TEST(ModularTest, Inv) {
   }
 }
 
+TEST(ModularTest, RootOfUnity) {
+  for (int k : {1, 2, 7, 14, 17, 1 << 23, 7 * 17 * 64}) {
+    auto w = Mint::RootOfUnity(k);
+    EXPECT_EQ(Mint(1), w.Power(k));
+    for (int i = 1; i < min(k, N); i++) EXPECT_NE(Mint(1), w.Power(i));
+  }
+  EXPECT_EQ(Mint(0), Mint::RootOfUnity(3));
+  EXPECT_EQ(Mint(0), Mint::RootOfUnity(1 << 24));
+}
+
 TEST(ModularTest, Power) {
   for (int it = 0; it < sqrt(N); it++) {
     Mint a(rng());
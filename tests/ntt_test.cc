@@ -11,6 +11,18 @@ class NttTest : public ::testing::Test {
   NTT ntt;
 };
 
+vector<int> NaiveMatch(const string &text, const string &pattern) {
+  vector<int> res;
+  for (int i = 0; i + pattern.size() <= text.size(); i++) {
+    bool ok = true;
+    for (int j = 0; j < pattern.size() && ok; j++) {
+      ok = text[i + j] == '?' || pattern[j] == '?' || text[i + j] == pattern[j];
+    }
+    if (ok) res.push_back(i);
+  }
+  return res;
+}
+
 template <int T>
 vector<Modular<T>> Naive(const vector<Modular<T>> &a,
                          const vector<Modular<T>> &b) {
@@ -91,3 +103,67 @@ TEST_F(NttTest, Size) {
     EXPECT_EQ(Naive(a, b), ntt.Mult(a, b));
   }
 }
+
+TEST_F(NttTest, Mult2D) {
+  EXPECT_EQ(vector<vector<Mint>>{},
+            ntt.Mult2D(vector<vector<Mint>>{}, vector<vector<Mint>>{}));
+  for (int it = 0; it < 100; it++) {
+    int n = rng() % 20 + 1, m = rng() % 20 + 1;
+    int p = rng() % 20 + 1, q = rng() % 20 + 1;
+    vector<vector<Mint>> a(n, vector<Mint>(m));
+    vector<vector<Mint>> b(p, vector<Mint>(q));
+    for (auto &row : a) {
+      for (auto &u : row) u = Mint(rng() % MOD);
+    }
+    for (auto &row : b) {
+      for (auto &u : row) u = Mint(rng() % MOD);
+    }
+    vector<vector<Mint>> expected(n + p - 1, vector<Mint>(m + q - 1));
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        for (int x = 0; x < p; x++) {
+          for (int y = 0; y < q; y++) {
+            expected[i + x][j + y] += a[i][j] * b[x][y];
+          }
+        }
+      }
+    }
+    EXPECT_EQ(expected, ntt.Mult2D(a, b));
+  }
+}
+
+TEST_F(NttTest, WildcardMatch) {
+  EXPECT_TRUE(ntt.WildcardMatch("AC", "ACG", '?').empty());
+  EXPECT_TRUE(ntt.WildcardMatch("AC", "", '?').empty());
+  for (int it = 0; it < 200; it++) {
+    int n = rng() % 200 + 1;
+    int m = rng() % min(n, 10) + 1;
+    string text(n, ' '), pattern(m, ' ');
+    for (auto &c : text) c = "ACGT?"[rng() % 5];
+    for (auto &c : pattern) c = "ACGT?"[rng() % 5];
+    EXPECT_EQ(NaiveMatch(text, pattern), ntt.WildcardMatch(text, pattern, '?'));
+  }
+}
+
+// 126 characters, where sums of powers of the codes are far beyond doubles
+TEST_F(NttTest, WildcardMatchLarge) {
+  auto random_char = [&]() {
+    char c = static_cast<char>(rng() % 126 + 1);
+    return c == '?' ? '\x7f' : c;
+  };
+  const int n = 200000, m = 10;
+  for (int tc = 0; tc < 3; tc++) {
+    string text(n, ' '), pattern(m, ' ');
+    for (auto &c : text) c = rng() % 100 ? random_char() : '?';
+    for (auto &c : pattern) c = rng() % 5 ? random_char() : '?';
+    for (int it = 0; it < 20; it++) {
+      int i = rng() % (n - m + 1);
+      for (int j = 0; j < m; j++) {
+        if (pattern[j] != '?' && text[i + j] != '?') text[i + j] = pattern[j];
+      }
+    }
+    auto expected = NaiveMatch(text, pattern);
+    EXPECT_GE(expected.size(), 1);
+    EXPECT_EQ(expected, ntt.WildcardMatch(text, pattern, '?'));
+  }
+}
@@ -5,12 +5,27 @@
 const int N = 100;
 
 mt19937 rng;
+mt19937_64 rng64;
 
 TEST(SegmentTreeTest, One) {
   SegmentTree<Node<int>> t(1);
   t.Update(0, 0, 1);
 }
 
+TEST(SegmentTreeTest, Empty) {
+  SegmentTree<Node<int>> t(0);
+  SegmentTree<Node<int>> u(0, vector<int>());
+  SegmentTree<Node<int>> v(0, vector<int>(), 4);
+  SegmentTreeBeats<NodeBeats<int>> b(0);
+  SegmentTreeBeats<NodeBeats<int>> c(0, vector<int>());
+  BottomUpSegmentTree<Node<int>> d(0);
+  BottomUpSegmentTree<Node<int>> e(0, vector<int>());
+  CompactSegmentTree<SumAdd<int>> f(0);
+  PersistentSegmentTree<Node<int>> g(0);
+  PersistentSegmentTree<Node<int>> h(0, vector<int>());
+  EXPECT_EQ(1, g.Nodes());
+}
+
 template <typename T>
 void SingleAdd() {
   for (int it = 0; it < N; it++) {
@@ -204,3 +219,498 @@ TEST(SegmentTreeTest, MaxTest) {
     }
   }
 }
+
+template <typename T>
+void BottomUpRandomTest() {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int tc = rng() % N + 1;
+    vector<T> a(n);
+    for (auto &u : a) {
+      u = T(rng() % N);
+    }
+    BottomUpSegmentTree<Node<T>> t(n, a);
+    while (tc--) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        T val(rng() % N - N / 2);
+        t.Update(l, r, val);
+        for (int i = l; i <= r; i++) {
+          a[i] += val;
+        }
+      } else {
+        T res(0);
+        for (int i = l; i <= r; i++) {
+          res += a[i];
+        }
+        EXPECT_EQ(res, t.Get(l, r).sum);
+      }
+    }
+  }
+}
+
+TEST(SegmentTreeTest, BottomUpRandomTest) {
+  BottomUpRandomTest<int>();
+  BottomUpRandomTest<Modular<127>>();
+}
+
+TEST(SegmentTreeTest, BottomUpMaxTest) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int tc = rng() % N + 1;
+    vector<int> a(n);
+    for (auto &u : a) {
+      u = rng() % N - N;
+    }
+    BottomUpSegmentTree<NodeMax<int>> t(n, a);
+    while (tc--) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        int val(rng() % N - N / 2);
+        t.Update(l, r, val);
+        for (int i = l; i <= r; i++) {
+          a[i] += val;
+        }
+      } else {
+        int res = *max_element(a.begin() + l, a.begin() + r + 1);
+        ASSERT_EQ(res, t.Get(l, r).max_val);
+      }
+    }
+  }
+}
+
+template <typename Tree>
+void MaxRightMinLeftTest() {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int tc = rng() % N + 1;
+    vector<int> a(n);
+    for (auto &u : a) {
+      u = rng() % N;
+    }
+    Tree t(n, a);
+    while (tc--) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        int val = rng() % N;
+        t.Update(l, r, val);
+        for (int i = l; i <= r; i++) {
+          a[i] += val;
+        }
+      } else {
+        int limit = rng() % (N * N);
+        auto f = [&](const Node<int> &u) { return u.sum <= limit; };
+        int right = l - 1;
+        for (int i = l, sum = 0; i < n && (sum += a[i]) <= limit; i++) {
+          right = i;
+        }
+        int left = r + 1;
+        for (int i = r, sum = 0; i >= 0 && (sum += a[i]) <= limit; i--) {
+          left = i;
+        }
+        ASSERT_EQ(right, t.MaxRight(l, f));
+        ASSERT_EQ(left, t.MinLeft(r, f));
+      }
+    }
+  }
+}
+
+TEST(SegmentTreeTest, MaxRightMinLeft) {
+  MaxRightMinLeftTest<SegmentTree<Node<int>>>();
+  MaxRightMinLeftTest<BottomUpSegmentTree<Node<int>>>();
+}
+
+TEST(SegmentTreeTest, LeftRightMostLambda) {
+  vector<int> a = {3, 1, 4, 1, 5, 9, 2, 6};
+  SegmentTree<NodeMax<int>> t(a.size(), a);
+  auto f = [](const NodeMax<int> &u, int val) { return u.max_val >= val; };
+  EXPECT_EQ(2, t.LeftMostHas(1, 7, f, 4));
+  EXPECT_EQ(7, t.RightMostHas(1, 7, f, 4));
+  EXPECT_EQ(-1, t.LeftMostHas(0, 3, f, 5));
+}
+
+template <typename T>
+void CompactRandomTest() {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int tc = rng() % N + 1;
+    vector<T> a(n);
+    for (auto &u : a) {
+      u = T(rng() % N);
+    }
+    CompactSegmentTree<SumAdd<T>> t(n, a);
+    while (tc--) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        T val(rng() % N - N / 2);
+        t.Update(l, r, val);
+        for (int i = l; i <= r; i++) {
+          a[i] += val;
+        }
+      } else {
+        T res(0);
+        for (int i = l; i <= r; i++) {
+          res += a[i];
+        }
+        EXPECT_EQ(res, t.Get(l, r));
+      }
+    }
+  }
+}
+
+TEST(SegmentTreeTest, CompactRandomTest) {
+  CompactRandomTest<int>();
+  CompactRandomTest<Modular<127>>();
+}
+
+template <typename T>
+void PersistentRandomTest() {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int tc = rng() % N + 1;
+    vector<vector<T>> a(1, vector<T>(n));
+    for (auto &u : a[0]) {
+      u = T(rng() % N);
+    }
+    PersistentSegmentTree<Node<T>> t(n, a[0]);
+    while (tc--) {
+      int v = rng() % a.size();
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        T val(rng() % N - N / 2);
+        EXPECT_EQ(a.size(), t.Update(v, l, r, val));
+        a.push_back(a[v]);
+        for (int i = l; i <= r; i++) {
+          a.back()[i] += val;
+        }
+      } else {
+        T res(0);
+        for (int i = l; i <= r; i++) {
+          res += a[v][i];
+        }
+        EXPECT_EQ(res, t.Get(v, l, r).sum);
+      }
+    }
+    EXPECT_EQ(a.size(), t.Versions());
+  }
+}
+
+TEST(SegmentTreeTest, PersistentRandomTest) {
+  PersistentRandomTest<int>();
+  PersistentRandomTest<Modular<127>>();
+}
+
+TEST(SegmentTreeTest, PersistentMax) {
+  PersistentSegmentTree<NodeMax<int>> t(5);
+  auto v1 = t.Update(0, 1, 3, 4);
+  auto v2 = t.Update(v1, 3, 4, 2);
+  auto v3 = t.Update(0, 0, 0, 1);
+  EXPECT_EQ(0, t.Get(0, 0, 4).max_val);
+  EXPECT_EQ(4, t.Get(v1, 0, 4).max_val);
+  EXPECT_EQ(6, t.Get(v2, 2, 4).max_val);
+  EXPECT_EQ(4, t.Get(v2, 1, 2).max_val);
+  EXPECT_EQ(1, t.Get(v3, 0, 4).max_val);
+  EXPECT_EQ(0, t.Get(v3, 1, 4).max_val);
+}
+
+TEST(SegmentTreeTest, DynamicRandomTest) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    long long lo = static_cast<int>(rng() % N) - N / 2;
+    int tc = rng() % N + 1;
+    vector<int> a(n);
+    DynamicSegmentTree<Node<int>> t(lo, lo + n - 1);
+    while (tc--) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        int val = rng() % N - N / 2;
+        t.Update(lo + l, lo + r, val);
+        for (int i = l; i <= r; i++) {
+          a[i] += val;
+        }
+      } else {
+        int res = 0;
+        for (int i = l; i <= r; i++) {
+          res += a[i];
+        }
+        EXPECT_EQ(res, t.Get(lo + l, lo + r).sum);
+      }
+    }
+  }
+}
+
+void DynamicLarge(long long lo, long long hi) {
+  using T = Modular<1000000007>;
+  DynamicSegmentTree<Node<T>> t(lo, hi);
+  auto len = static_cast<unsigned long long>(hi - lo) + 1;
+  vector<tuple<long long, long long, int>> updates;
+  for (int it = 0; it < N * 10; it++) {
+    auto l = lo + static_cast<long long>(rng64() % len);
+    auto r = lo + static_cast<long long>(rng64() % len);
+    if (l > r) swap(l, r);
+    if (rng() % 2) {
+      int val = rng() % N;
+      t.Update(l, r, T(val));
+      updates.emplace_back(l, r, val);
+    } else {
+      T res(0);
+      for (auto [x, y, val] : updates) {
+        if (max(x, l) <= min(y, r)) {
+          res += T(val) * T(min(y, r) - max(x, l) + 1);
+        }
+      }
+      EXPECT_EQ(res, t.Get(l, r).sum);
+    }
+  }
+  auto depth = 64 - __builtin_clzll(len);
+  EXPECT_LE(t.Nodes(), 2 + updates.size() * 4 * depth);
+}
+
+TEST(SegmentTreeTest, DynamicLargeTest) {
+  DynamicLarge(0, 1e18);
+  // the widest range allowed
+  DynamicLarge(-(1LL << 62) + 1, (1LL << 62) - 1);
+}
+
+TEST(SegmentTreeTest, DynamicMax) {
+  const long long MAX = 1e18, HALF = 5e17;
+  DynamicSegmentTree<NodeMax<long long>> t(-MAX, MAX);
+  t.Update(-HALF, HALF, 3);
+  t.Update(0, MAX, 4);
+  EXPECT_EQ(0, t.Get(-MAX, -HALF - 1).max_val);
+  EXPECT_EQ(3, t.Get(-MAX, -1).max_val);
+  EXPECT_EQ(7, t.Get(-MAX, MAX).max_val);
+  EXPECT_EQ(4, t.Get(HALF + 1, HALF + 1).max_val);
+}
+
+TEST(SegmentTreeTest, BeatsRandomTest) {
+  using Beats = NodeBeats<long long>;
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    int tc = rng() % (N * 5) + 1;
+    vector<long long> a(n);
+    for (auto &u : a) {
+      u = rng() % N - N / 2;
+    }
+    SegmentTreeBeats<Beats> t(n, a);
+    while (tc--) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      long long x = rng() % N - N / 2;
+      int type = rng() % 4;
+      if (type == 0) {
+        t.Update(l, r, Beats::Chmin(x));
+        for (int i = l; i <= r; i++) {
+          a[i] = min(a[i], x);
+        }
+      } else if (type == 1) {
+        t.Update(l, r, Beats::Chmax(x));
+        for (int i = l; i <= r; i++) {
+          a[i] = max(a[i], x);
+        }
+      } else if (type == 2) {
+        t.Update(l, r, Beats::Add(x));
+        for (int i = l; i <= r; i++) {
+          a[i] += x;
+        }
+      } else {
+        auto res = t.Get(l, r);
+        EXPECT_EQ(accumulate(a.begin() + l, a.begin() + r + 1, 0LL), res.sum);
+        EXPECT_EQ(*max_element(a.begin() + l, a.begin() + r + 1), res.max1);
+        EXPECT_EQ(*min_element(a.begin() + l, a.begin() + r + 1), res.min1);
+      }
+    }
+  }
+}
+
+TEST(SegmentTreeTest, BeatsZeroInit) {
+  using Beats = NodeBeats<int>;
+  SegmentTreeBeats<Beats> t(5);
+  t.Update(1, 3, Beats::Chmax(4));
+  t.Update(0, 2, Beats::Chmin(2));
+  t.Update(2, 4, Beats::Add(1));
+  // 0 2 3 5 1
+  EXPECT_EQ(11, t.Get(0, 4).sum);
+  EXPECT_EQ(5, t.Get(0, 4).max1);
+  EXPECT_EQ(1, t.Get(2, 4).min1);
+}
+
+TEST(SegmentTreeTest, BeatsExtremeBounds) {
+  using Beats = NodeBeats<long long>;
+  const auto LOW = numeric_limits<long long>::min();
+  const auto HIGH = numeric_limits<long long>::max();
+  SegmentTreeBeats<Beats> low(1, vector<long long>{-7});
+  low.Update(0, 0, Beats::Chmin(LOW));
+  EXPECT_EQ(LOW, low.Get(0, 0).sum);
+  SegmentTreeBeats<Beats> high(1, vector<long long>{7});
+  high.Update(0, 0, Beats::Chmax(HIGH));
+  EXPECT_EQ(HIGH, high.Get(0, 0).sum);
+  SegmentTreeBeats<Beats> t(5, vector<long long>{1, 2, -3, 4, -5});
+  t.Update(2, 2, Beats::Chmin(LOW));
+  t.Update(3, 3, Beats::Chmax(HIGH));
+  EXPECT_EQ(LOW, t.Get(0, 4).min1);
+  EXPECT_EQ(HIGH, t.Get(0, 4).max1);
+  EXPECT_EQ(-3, t.Get(0, 4).sum);
+  EXPECT_EQ(-5, t.Get(4, 4).sum);
+}
+
+// range assigning and range sum getting, updates do not commute
+struct NodeAssign {
+  static NodeAssign worst() { return NodeAssign(); }
+
+  void Apply(long long l, long long r, int val) {
+    sum = val * (r - l + 1);
+    assign = val;
+  }
+
+  void Pull(long long l, long long r, const NodeAssign &u,
+            const NodeAssign &v) {
+    sum = u.sum + v.sum;
+    assign = -1;
+  }
+
+  void Push(long long l, long long r, NodeAssign &u, NodeAssign &v) {
+    if (assign == -1) return;
+    auto m = l + r >> 1;
+    u.Apply(l, m, assign);
+    v.Apply(m + 1, r, assign);
+    assign = -1;
+  }
+
+  long long sum = 0;
+  int assign = -1;
+};
+
+template <typename T, typename F>
+void BatchRandomTest(const F &get) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    vector<int> a(n);
+    for (auto &u : a) {
+      u = rng() % N;
+    }
+    SegmentTree<T> batch(n, a), single(n, a);
+    for (int round = 0; round < 5; round++) {
+      vector<tuple<int, int, int>> updates(rng() % N);
+      for (auto &[l, r, val] : updates) {
+        l = rng() % n;
+        r = rng() % n;
+        if (l > r) swap(l, r);
+        val = rng() % N;
+        single.Update(l, r, val);
+      }
+      batch.ApplyBatch(updates);
+      vector<pair<int, int>> ranges(rng() % N);
+      for (auto &[l, r] : ranges) {
+        l = rng() % n;
+        r = rng() % n;
+        if (l > r) swap(l, r);
+      }
+      auto res = batch.QueryBatch(ranges);
+      ASSERT_EQ(ranges.size(), res.size());
+      for (int i = 0; i < ranges.size(); i++) {
+        auto [l, r] = ranges[i];
+        EXPECT_EQ(get(single.Get(l, r)), get(res[i]));
+      }
+    }
+  }
+}
+
+TEST(SegmentTreeTest, BatchRandomTest) {
+  BatchRandomTest<Node<int>>([](const auto &u) { return u.sum; });
+  BatchRandomTest<NodeMax<int>>([](const auto &u) { return u.max_val; });
+  BatchRandomTest<NodeAssign>([](const auto &u) { return u.sum; });
+}
+
+TEST(SegmentTreeTest, ParallelInit) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % (N * 10) + 1;
+    int threads = rng() % 8 + 1;
+    vector<int> a(n);
+    for (auto &u : a) {
+      u = rng() % N - N / 2;
+    }
+    SegmentTree<Node<int>> serial(n, a);
+    SegmentTree<Node<int>> parallel(n, a, threads);
+    SegmentTree<NodeMax<int>> parallel_max(n, a, threads);
+    for (int tc = 0; tc < N; tc++) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      EXPECT_EQ(serial.Get(l, r).sum, parallel.Get(l, r).sum);
+      EXPECT_EQ(*max_element(a.begin() + l, a.begin() + r + 1),
+                parallel_max.Get(l, r).max_val);
+    }
+  }
+}
+
+TEST(SegmentTreeTest, ConstGet) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    vector<int> a(n);
+    for (auto &u : a) {
+      u = rng() % N;
+    }
+    SegmentTree<Node<int>> t(n, a);
+    const auto &view = t;
+    for (int tc = 0; tc < N; tc++) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      if (rng() % 2) {
+        int val = rng() % N - N / 2;
+        t.Update(l, r, val);
+        for (int i = l; i <= r; i++) {
+          a[i] += val;
+        }
+      } else {
+        EXPECT_EQ(accumulate(a.begin() + l, a.begin() + r + 1, 0),
+                  view.Get(l, r).sum);
+      }
+    }
+  }
+}
+
+TEST(SegmentTreeTest, ConcurrentReaders) {
+  const int n = 1000, updates = 2000;
+  ConcurrentSegmentTree<Node<long long>> t(n);
+  atomic<bool> done{false};
+  vector<thread> readers;
+  for (int id = 0; id < 3; id++) {
+    readers.emplace_back([&, id] {
+      mt19937 gen(id);
+      long long last = 0;
+      while (!done) {
+        int l = gen() % n;
+        int r = gen() % n;
+        if (l > r) swap(l, r);
+        // the writer only adds to the whole array, so every snapshot is
+        // constant and snapshots never go back in time
+        auto sum = t.Get(l, r).sum;
+        EXPECT_EQ(0, sum % (r - l + 1));
+        EXPECT_LE(last, sum / (r - l + 1));
+        last = sum / (r - l + 1);
+      }
+    });
+  }
+  for (int i = 0; i < updates; i++) {
+    t.Update(0, n - 1, 1);
+  }
+  done = true;
+  for (auto &reader : readers) reader.join();
+  EXPECT_EQ(updates, t.Get(0, 0).sum);
+  EXPECT_EQ(1LL * updates * n, t.Get(0, n - 1).sum);
+}
@@ -0,0 +1,93 @@
+#include <../src/wavelet_matrix.h>
+#include <gtest/gtest.h>
+
+const int N = 100;
+
+mt19937 rng;
+mt19937_64 rng_64;
+
+TEST(WaveletMatrixTest, BitVector) {
+  int n = N * 10;
+  BitVector b(n);
+  vector<int> a(n);
+  for (int i = 0; i < n; i++) {
+    if (rng() % 3 == 0) {
+      a[i] = 1;
+      b.Set(i);
+    }
+  }
+  b.Build();
+  int ones = 0;
+  for (int i = 0; i <= n; i++) {
+    EXPECT_EQ(ones, b.Rank1(i));
+    EXPECT_EQ(i - ones, b.Rank0(i));
+    if (i < n) {
+      EXPECT_EQ(a[i], b.Get(i));
+      ones += a[i];
+    }
+  }
+}
+
+TEST(WaveletMatrixTest, One) {
+  WaveletMatrix<int> w(vector<int>{7});
+  EXPECT_EQ(7, w.KthSmallest(0, 0, 0));
+  EXPECT_EQ(0, w.RangeFreq(0, 0, 7));
+  EXPECT_EQ(1, w.RangeFreq(0, 0, 8));
+  EXPECT_EQ(nullopt, w.PrevValue(0, 0, 7));
+  EXPECT_EQ(7, w.NextValue(0, 0, 7));
+  EXPECT_EQ(nullopt, w.NextValue(0, 0, 8));
+}
+
+template <typename T>
+void RandomTest(const function<T()> &gen) {
+  for (int it = 0; it < N; it++) {
+    int n = rng() % N + 1;
+    vector<T> a(n);
+    for (auto &u : a) {
+      u = gen();
+    }
+    WaveletMatrix<T> w(a);
+    for (int tc = 0; tc < N; tc++) {
+      int l = rng() % n;
+      int r = rng() % n;
+      if (l > r) swap(l, r);
+      vector<T> b(a.begin() + l, a.begin() + r + 1);
+      sort(b.begin(), b.end());
+      int k = rng() % b.size();
+      EXPECT_EQ(b[k], w.KthSmallest(l, r, k));
+      T x = gen(), y = gen();
+      auto less = lower_bound(b.begin(), b.end(), x) - b.begin();
+      EXPECT_EQ(less, w.RangeFreq(l, r, x));
+      EXPECT_EQ(max(0L, lower_bound(b.begin(), b.end(), y) - b.begin() - less),
+                w.RangeFreq(l, r, x, y));
+      auto prev = w.PrevValue(l, r, x);
+      auto next = w.NextValue(l, r, x);
+      if (less == 0) {
+        EXPECT_EQ(nullopt, prev);
+      } else {
+        EXPECT_EQ(b[less - 1], prev);
+      }
+      if (less == b.size()) {
+        EXPECT_EQ(nullopt, next);
+      } else {
+        EXPECT_EQ(b[less], next);
+      }
+    }
+  }
+}
+
+TEST(WaveletMatrixTest, RandomTest) {
+  RandomTest<int>([] { return static_cast<int>(rng() % N) - N / 2; });
+  RandomTest<int>([] { return static_cast<int>(rng() % 3); });
+  RandomTest<long long>([] { return static_cast<long long>(rng_64()); });
+}
+
+TEST(WaveletMatrixTest, Strings) {
+  vector<string> a = {"b", "a", "c", "a", "d"};
+  WaveletMatrix<string> w(a);
+  EXPECT_EQ("a", w.KthSmallest(0, 4, 1));
+  EXPECT_EQ("b", w.KthSmallest(0, 4, 2));
+  EXPECT_EQ(2, w.RangeFreq(1, 4, "b"));
+  EXPECT_EQ("c", w.PrevValue(1, 4, "cc"));
+  EXPECT_EQ(nullopt, w.NextValue(0, 3, "cc"));
+}